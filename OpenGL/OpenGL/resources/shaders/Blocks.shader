@@ -0,0 +1,48 @@
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+
+out vec2 v_TexCoord;
+
+//FrameUniforms and ObjectUniforms in UniformBuffer.h
+layout(std140) uniform Frame
+{
+   mat4 u_ViewProj;
+   mat4 u_View;
+   mat4 u_Projection;
+   vec3 u_CameraPosition;
+   float u_Time;
+};
+
+layout(std140) uniform Object
+{
+   mat4 u_Model;
+   vec4 u_Color;
+};
+
+out vec4 v_Color;
+
+void main()
+{
+   gl_Position = u_ViewProj * u_Model * position;
+   v_TexCoord = texCoord;
+   v_Color = u_Color;
+}
+
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_TexCoord;
+in vec4 v_Color;
+uniform sampler2D u_Texture;
+
+void main()
+{
+	vec4 texColor = texture(u_Texture, v_TexCoord);
+	color = texColor * v_Color;
+}
@@ -0,0 +1,36 @@
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+//Per instance (divisor 1), a mat4 takes four attribute slots
+layout(location = 2) in mat4 a_Model;
+layout(location = 6) in vec4 a_Color;
+
+out vec2 v_TexCoord;
+out vec4 v_Color;
+
+uniform mat4 u_ViewProj;
+
+void main()
+{
+   gl_Position = u_ViewProj * a_Model * position;
+   v_TexCoord = texCoord;
+   v_Color = a_Color;
+}
+
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_TexCoord;
+in vec4 v_Color;
+uniform sampler2D u_Texture;
+
+void main()
+{
+	vec4 texColor = texture(u_Texture, v_TexCoord);
+	color = texColor * v_Color;
+}
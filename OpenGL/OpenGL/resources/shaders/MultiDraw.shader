@@ -0,0 +1,33 @@
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec4 position;
+layout(location = 1) in float a_DrawID; //Per instance, baseInstance of the indirect command
+
+flat out vec4 v_Color;
+
+uniform mat4 u_ViewProj;
+//Per-draw data, 5 texels per draw: model matrix columns then colour
+uniform samplerBuffer u_DrawData;
+
+void main()
+{
+   int base = int(a_DrawID) * 5;
+   mat4 model = mat4(texelFetch(u_DrawData, base), texelFetch(u_DrawData, base + 1),
+                     texelFetch(u_DrawData, base + 2), texelFetch(u_DrawData, base + 3));
+   gl_Position = u_ViewProj * model * position;
+   v_Color = texelFetch(u_DrawData, base + 4);
+}
+
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+flat in vec4 v_Color;
+
+void main()
+{
+	color = v_Color;
+}
@@ -0,0 +1,41 @@
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+
+out vec2 v_TexCoord;
+
+//FrameUniforms in UniformBuffer.h, uploaded once a frame for every program
+layout(std140) uniform Frame
+{
+   mat4 u_ViewProj;
+   mat4 u_View;
+   mat4 u_Projection;
+   vec3 u_CameraPosition;
+   float u_Time;
+};
+
+uniform mat4 u_Model;
+
+void main()
+{
+   gl_Position = u_ViewProj * u_Model * position;
+   v_TexCoord = texCoord;
+}
+
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_TexCoord;
+uniform vec4 u_Color;
+uniform sampler2D u_Texture;
+
+void main()
+{
+	vec4 texColor = texture(u_Texture, v_TexCoord);
+	color = texColor;
+}
@@ -0,0 +1,144 @@
+#include "BatchRenderer2D.h"
+#include "Profiler.h"
+#include <cstring>
+
+static const unsigned int s_WhitePixel = 0xffffffff;
+static constexpr UniformID s_ViewProj("u_ViewProj");
+
+BatchRenderer2D::BatchRenderer2D(const Renderer& renderer, const std::string& shaderPath)
+    :m_Renderer(renderer),
+    m_VertexBuffer(GL_ARRAY_BUFFER, 3 * MaxVertices * sizeof(QuadVertex)), //A few full batches in flight
+    m_IndexBuffer(GenerateQuadIndices(MaxQuads).data(), MaxIndices),
+    m_Shader(shaderPath),
+    m_WhiteTexture(1, 1, &s_WhitePixel),
+    m_Vertices(MaxVertices),
+    m_QuadCount(0),
+    m_TextureSlots(),
+    m_TextureSlotCount(1),
+    m_ViewProjection(1.0f)
+{
+    m_VertexArray.AddBuffer<QuadVertex>(m_VertexBuffer);
+
+    //Slot 0 is always the white texture so untextured quads can share the batch
+    m_TextureSlots[0] = &m_WhiteTexture;
+
+    int samplers[MaxTextureSlots];
+    for (unsigned int i = 0; i < MaxTextureSlots; i++)
+        samplers[i] = i;
+    m_Shader.Bind();
+    m_Shader.setUniform1iv("u_Textures", MaxTextureSlots, samplers);
+    m_Shader.Unbind();
+}
+
+void BatchRenderer2D::BeginBatch(const glm::mat4& viewProjection)
+{
+    m_ViewProjection = viewProjection;
+    m_QuadCount = 0;
+    m_TextureSlotCount = 1;
+}
+
+void BatchRenderer2D::DrawQuad(const glm::vec2& position, const glm::vec2& size, const glm::vec4& color)
+{
+    if (m_QuadCount >= MaxQuads)
+        Flush();
+
+    PushQuad(position, size, color, 0.0f);
+}
+
+void BatchRenderer2D::DrawQuad(const glm::vec2& position, const glm::vec2& size, const Texture& texture, const glm::vec4& tint)
+{
+    if (m_QuadCount >= MaxQuads)
+        Flush();
+
+    //May flush too, when every slot is taken by another texture
+    float texIndex = GetTextureSlot(texture);
+    PushQuad(position, size, tint, texIndex);
+}
+
+void BatchRenderer2D::EndBatch()
+{
+    Flush();
+    m_VertexBuffer.EndFrame();
+}
+
+void BatchRenderer2D::Flush()
+{
+    if (m_QuadCount == 0)
+        return;
+    PROFILE_GPU_SCOPE("BatchRenderer2D::Flush");
+
+    //Aligned to whole vertices so the allocation can be drawn with a base vertex
+    unsigned int size = m_QuadCount * 4 * sizeof(QuadVertex);
+    StreamBuffer::Allocation vertices = m_VertexBuffer.Allocate(size, sizeof(QuadVertex));
+    if (!vertices.Data)
+    {
+        //Already reported by the StreamBuffer, the batch is dropped
+        m_QuadCount = 0;
+        m_TextureSlotCount = 1;
+        return;
+    }
+    memcpy(vertices.Data, m_Vertices.data(), size);
+    m_VertexBuffer.Commit();
+
+    for (unsigned int i = 0; i < m_TextureSlotCount; i++)
+        m_TextureSlots[i]->Bind(i);
+
+    m_Shader.Bind();
+    m_Shader.setUniformMat4f(s_ViewProj, m_ViewProjection);
+    m_Renderer.DrawBaseVertex(m_VertexArray, m_IndexBuffer, m_Shader, m_QuadCount * 6, vertices.Offset / sizeof(QuadVertex));
+
+    m_Stats.DrawCalls++;
+    m_QuadCount = 0;
+    m_TextureSlotCount = 1;
+}
+
+float BatchRenderer2D::GetTextureSlot(const Texture& texture)
+{
+    for (unsigned int i = 1; i < m_TextureSlotCount; i++)
+    {
+        if (m_TextureSlots[i] == &texture)
+            return (float)i;
+    }
+
+    if (m_TextureSlotCount >= MaxTextureSlots)
+        Flush();
+
+    m_TextureSlots[m_TextureSlotCount] = &texture;
+    return (float)m_TextureSlotCount++;
+}
+
+void BatchRenderer2D::PushQuad(const glm::vec2& position, const glm::vec2& size, const glm::vec4& color, float texIndex)
+{
+    static const glm::vec2 texCoords[4] = { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f } };
+
+    QuadVertex* vertex = &m_Vertices[m_QuadCount * 4];
+    for (unsigned int i = 0; i < 4; i++)
+    {
+        vertex[i].Position = glm::vec3(position + texCoords[i] * size, 0.0f);
+        vertex[i].Color = color;
+        vertex[i].TexCoord = texCoords[i];
+        vertex[i].TexIndex = texIndex;
+    }
+    m_QuadCount++;
+    m_Stats.QuadCount++;
+}
+
+std::vector<unsigned int> BatchRenderer2D::GenerateQuadIndices(unsigned int quadCount)
+{
+    //Same winding as the single quad in Sandbox: 0,1,2 and 2,3,0 for every quad
+    std::vector<unsigned int> indices(quadCount * 6);
+    unsigned int offset = 0;
+    for (unsigned int i = 0; i < indices.size(); i += 6)
+    {
+        indices[i + 0] = offset + 0;
+        indices[i + 1] = offset + 1;
+        indices[i + 2] = offset + 2;
+
+        indices[i + 3] = offset + 2;
+        indices[i + 4] = offset + 3;
+        indices[i + 5] = offset + 0;
+
+        offset += 4;
+    }
+    return indices;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <vector>
+#include "Renderer.h"
+#include "StreamBuffer.h"
+#include "Texture.h"
+#include "VertexFormat.h"
+#include "glm/glm.hpp"
+
+//Collects quads into one dynamic vertex buffer and draws them with a single draw call per flush.
+//A flush only happens when the vertex buffer or the texture slots are full, or at EndBatch.
+//Vertices go into a StreamBuffer ring, so a flush never waits for the GPU to finish the previous one.
+class BatchRenderer2D
+{
+public:
+	static const unsigned int MaxQuads = 10000;
+	static const unsigned int MaxVertices = MaxQuads * 4;
+	static const unsigned int MaxIndices = MaxQuads * 6;
+	static const unsigned int MaxTextureSlots = 16; //Must match the u_Textures array in Batch.shader
+
+	struct QuadVertex
+	{
+		glm::vec3 Position;
+		glm::vec4 Color;
+		glm::vec2 TexCoord;
+		float TexIndex;
+	};
+
+	struct Stats
+	{
+		unsigned int DrawCalls = 0;
+		unsigned int QuadCount = 0;
+	};
+private:
+	const Renderer& m_Renderer;
+	VertexArray m_VertexArray;
+	StreamBuffer m_VertexBuffer;
+	IndexBuffer m_IndexBuffer;
+	Shader m_Shader;
+	Texture m_WhiteTexture;
+
+	std::vector<QuadVertex> m_Vertices;
+	unsigned int m_QuadCount;
+	const Texture* m_TextureSlots[MaxTextureSlots];
+	unsigned int m_TextureSlotCount;
+	glm::mat4 m_ViewProjection;
+	Stats m_Stats;
+public:
+	BatchRenderer2D(const Renderer& renderer, const std::string& shaderPath = "resources/shaders/Batch.shader");
+
+	void BeginBatch(const glm::mat4& viewProjection);
+	void DrawQuad(const glm::vec2& position, const glm::vec2& size, const glm::vec4& color);
+	void DrawQuad(const glm::vec2& position, const glm::vec2& size, const Texture& texture, const glm::vec4& tint = glm::vec4(1.0f));
+	void EndBatch(); //Flushes whatever is left of the frame
+	void Flush(); //Uploads the pending quads, draws them with one call and starts a new batch
+
+	inline const Stats& GetStats() const { return m_Stats; }
+	inline void ResetStats() { m_Stats = Stats(); }
+
+private:
+	float GetTextureSlot(const Texture& texture);
+	void PushQuad(const glm::vec2& position, const glm::vec2& size, const glm::vec4& color, float texIndex);
+	static std::vector<unsigned int> GenerateQuadIndices(unsigned int quadCount);
+};
+
+VERTEX_FORMAT(BatchRenderer2D::QuadVertex,
+	VERTEX_ATTRIBUTE(BatchRenderer2D::QuadVertex, Position),
+	VERTEX_ATTRIBUTE(BatchRenderer2D::QuadVertex, Color),
+	VERTEX_ATTRIBUTE(BatchRenderer2D::QuadVertex, TexCoord),
+	VERTEX_ATTRIBUTE(BatchRenderer2D::QuadVertex, TexIndex))
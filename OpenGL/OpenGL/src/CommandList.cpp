@@ -0,0 +1,49 @@
+#include "CommandList.h"
+#include <cstring>
+
+CommandList::CommandList()
+    :m_PendingUniforms(0)
+{
+}
+
+void CommandList::Reset()
+{
+    m_Draws.clear();
+    m_Uniforms.clear();
+    m_PendingUniforms = 0;
+}
+
+CommandList::UniformValue& CommandList::PushUniform(UniformID name, UniformType type)
+{
+    m_Uniforms.push_back({ name, type, {}, 0 });
+    UniformValue& uniform = m_Uniforms.back();
+    m_PendingUniforms++;
+    return uniform;
+}
+
+void CommandList::SetUniform1i(UniformID name, int value)
+{
+    PushUniform(name, UniformType::Int).Int = value;
+}
+
+void CommandList::SetUniform1f(UniformID name, float value)
+{
+    PushUniform(name, UniformType::Float).Data[0] = value;
+}
+
+void CommandList::SetUniform4f(UniformID name, const glm::vec4& value)
+{
+    memcpy(PushUniform(name, UniformType::Vec4).Data, &value[0], sizeof(glm::vec4));
+}
+
+void CommandList::SetUniformMat4f(UniformID name, const glm::mat4& matrix)
+{
+    memcpy(PushUniform(name, UniformType::Mat4).Data, &matrix[0][0], sizeof(glm::mat4));
+}
+
+void CommandList::Draw(const VertexArray& va, const IndexBuffer& ib, Shader& shader, const Texture* texture)
+{
+    unsigned int firstUniform = (unsigned int)m_Uniforms.size() - m_PendingUniforms;
+    m_Draws.push_back({ &va, &ib, &shader, texture, firstUniform, m_PendingUniforms });
+    m_PendingUniforms = 0;
+}
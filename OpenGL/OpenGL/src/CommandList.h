@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+#include "glm/glm.hpp"
+#include "UniformID.h"
+
+class VertexArray;
+class IndexBuffer;
+class Shader;
+class Texture;
+
+//Recorded draw work with no GL calls, so any thread can fill one. The thread owning the GL context
+//replays it through Renderer::Replay, in recording order.
+//Uniforms set before a Draw belong to that draw. Uniform names are hashed when recorded and not copied: use string literals.
+class CommandList
+{
+public:
+	enum class UniformType { Int, Float, Vec4, Mat4 };
+
+	struct UniformValue
+	{
+		UniformID Name;
+		UniformType Type;
+		float Data[16];
+		int Int;
+	};
+
+	struct DrawCommand
+	{
+		const VertexArray* VA;
+		const IndexBuffer* IB;
+		Shader* Program;
+		const Texture* Tex; //Bound to slot 0, may be null
+		unsigned int FirstUniform;
+		unsigned int UniformCount;
+	};
+private:
+	std::vector<DrawCommand> m_Draws;
+	std::vector<UniformValue> m_Uniforms;
+	unsigned int m_PendingUniforms; //Uniforms recorded since the last Draw
+public:
+	CommandList();
+
+	void Reset(); //Keeps the memory, so steady-state recording doesn't allocate
+
+	void SetUniform1i(UniformID name, int value);
+	void SetUniform1f(UniformID name, float value);
+	void SetUniform4f(UniformID name, const glm::vec4& value);
+	void SetUniformMat4f(UniformID name, const glm::mat4& matrix);
+	void Draw(const VertexArray& va, const IndexBuffer& ib, Shader& shader, const Texture* texture = nullptr);
+
+	inline const std::vector<DrawCommand>& GetDraws() const { return m_Draws; }
+	inline const std::vector<UniformValue>& GetUniforms() const { return m_Uniforms; }
+private:
+	UniformValue& PushUniform(UniformID name, UniformType type);
+};
@@ -0,0 +1,88 @@
+#include "CommandRecorder.h"
+#include "Renderer.h"
+#include "Profiler.h"
+
+CommandRecorder::CommandRecorder(unsigned int workerCount)
+    :m_Job(nullptr), m_Count(0), m_Generation(0), m_Pending(0), m_Quit(false)
+{
+    m_Lists.resize(workerCount + 1);
+    for (unsigned int i = 0; i < workerCount; i++)
+        m_Workers.emplace_back(&CommandRecorder::WorkerLoop, this, i + 1);
+}
+
+CommandRecorder::~CommandRecorder()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Quit = true;
+    }
+    m_WorkReady.notify_all();
+    for (std::thread& worker : m_Workers)
+        worker.join();
+}
+
+unsigned int CommandRecorder::DefaultWorkerCount()
+{
+    unsigned int cores = std::thread::hardware_concurrency(); //0 when unknown
+    return cores > 1 ? cores - 1 : 0;
+}
+
+void CommandRecorder::RecordRange(unsigned int listIndex)
+{
+    unsigned int listCount = (unsigned int)m_Lists.size();
+    unsigned int begin = (unsigned int)((unsigned long long)m_Count * listIndex / listCount);
+    unsigned int end = (unsigned int)((unsigned long long)m_Count * (listIndex + 1) / listCount);
+
+    PROFILE_SCOPE("CommandRecorder::Record");
+    CommandList& list = m_Lists[listIndex];
+    list.Reset();
+    if (begin < end)
+        (*m_Job)(list, begin, end);
+}
+
+void CommandRecorder::WorkerLoop(unsigned int listIndex)
+{
+    unsigned int seenGeneration = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_WorkReady.wait(lock, [&] { return m_Quit || m_Generation != seenGeneration; });
+            if (m_Quit)
+                return;
+            seenGeneration = m_Generation;
+        }
+
+        RecordRange(listIndex);
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Pending--;
+        }
+        m_WorkDone.notify_one();
+    }
+}
+
+void CommandRecorder::Record(unsigned int count, const RecordFunc& job)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Job = &job;
+        m_Count = count;
+        m_Pending = (unsigned int)m_Workers.size();
+        m_Generation++;
+    }
+    m_WorkReady.notify_all();
+
+    RecordRange(0);
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_WorkDone.wait(lock, [&] { return m_Pending == 0; });
+    m_Job = nullptr;
+}
+
+void CommandRecorder::Replay(const Renderer& renderer) const
+{
+    for (const CommandList& list : m_Lists)
+        renderer.Replay(list);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include "CommandList.h"
+
+class Renderer;
+
+//Persistent worker threads that fill one CommandList each in parallel. Record splits [0, count)
+//into contiguous ranges, one per list, and returns once all of them are recorded. The calling
+//thread records the first range itself. Replay then issues the lists in order, so the final draw
+//order is the same as a single-threaded loop over [0, count).
+class CommandRecorder
+{
+public:
+	//Records items [begin, end) into list. Runs on worker threads: no GL calls in here.
+	typedef std::function<void(CommandList& list, unsigned int begin, unsigned int end)> RecordFunc;
+private:
+	std::vector<std::thread> m_Workers;
+	std::vector<CommandList> m_Lists; //[0] belongs to the calling thread, [i + 1] to worker i
+
+	std::mutex m_Mutex;
+	std::condition_variable m_WorkReady;
+	std::condition_variable m_WorkDone;
+	const RecordFunc* m_Job;
+	unsigned int m_Count;
+	unsigned int m_Generation; //Bumped for every Record so workers know there is new work
+	unsigned int m_Pending;
+	bool m_Quit;
+public:
+	CommandRecorder(unsigned int workerCount = DefaultWorkerCount());
+	~CommandRecorder();
+
+	void Record(unsigned int count, const RecordFunc& job);
+	void Replay(const Renderer& renderer) const; //On the GL thread
+
+	inline const std::vector<CommandList>& GetLists() const { return m_Lists; }
+	inline unsigned int GetWorkerCount() const { return (unsigned int)m_Workers.size(); }
+
+	static unsigned int DefaultWorkerCount(); //One per core, minus the calling thread
+private:
+	void WorkerLoop(unsigned int listIndex);
+	void RecordRange(unsigned int listIndex);
+};
@@ -0,0 +1,122 @@
+#include "DeletionQueue.h"
+#include "Renderer.h"
+#include "GLStateCache.h"
+#include "VertexArrayCache.h"
+#include "GpuMemory.h"
+
+DeletionQueue::DeletionQueue()
+    :m_Enabled(true)
+{
+}
+
+DeletionQueue& DeletionQueue::Get()
+{
+    static DeletionQueue queue;
+    return queue;
+}
+
+void DeletionQueue::Enqueue(Type type, unsigned int name, unsigned long long bytes)
+{
+    if (name == 0)
+        return;
+    GpuMemory::Get().OnRelease(type, name);
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (!m_Enabled)
+    {
+        Delete({ type, name, bytes });
+        return;
+    }
+    m_Pending.push_back({ type, name, bytes });
+    m_Stats.QueueDepth++;
+    m_Stats.DeferredBytes += bytes;
+}
+
+void DeletionQueue::EndFrame()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (!m_Pending.empty())
+    {
+        GLCall(GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+        m_Fenced.push_back({ fence, std::move(m_Pending) });
+        m_Pending.clear();
+    }
+
+    while (!m_Fenced.empty())
+    {
+        GLCall(GLenum status = glClientWaitSync((GLsync)m_Fenced.front().Fence, 0, 0));
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            break;
+        Retire(m_Fenced.front());
+        m_Fenced.pop_front();
+    }
+    m_Stats.FramesInFlight = (unsigned int)m_Fenced.size();
+}
+
+void DeletionQueue::Flush()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    //No wait: GL keeps objects the GPU still uses alive on its own, this only gives up on avoiding the stall
+    for (Batch& batch : m_Fenced)
+        Retire(batch);
+    m_Fenced.clear();
+    for (const Entry& entry : m_Pending)
+        Delete(entry);
+    m_Pending.clear();
+    m_Stats.QueueDepth = 0;
+    m_Stats.DeferredBytes = 0;
+    m_Stats.FramesInFlight = 0;
+}
+
+void DeletionQueue::SetEnabled(bool enabled)
+{
+    if (!enabled)
+        Flush();
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Enabled = enabled;
+}
+
+DeletionQueue::Stats DeletionQueue::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Stats;
+}
+
+void DeletionQueue::Retire(Batch& batch)
+{
+    GLCall(glDeleteSync((GLsync)batch.Fence));
+    for (const Entry& entry : batch.Entries)
+    {
+        Delete(entry);
+        m_Stats.QueueDepth--;
+        m_Stats.DeferredBytes -= entry.Bytes;
+    }
+}
+
+void DeletionQueue::Delete(const Entry& entry)
+{
+    //The cache is told now and not at Enqueue: until here the name is alive and may still be bound
+    switch (entry.ObjectType)
+    {
+    case Type::Buffer:
+        GLCall(glDeleteBuffers(1, &entry.Name));
+        GLStateCache::Get().OnDeleteBuffer(entry.Name);
+        VertexArrayCache::Get().OnDeleteBuffer(entry.Name);
+        GpuMemory::Get().OnDelete(entry.ObjectType, entry.Name);
+        break;
+    case Type::Texture:
+        GLCall(glDeleteTextures(1, &entry.Name));
+        GLStateCache::Get().OnDeleteTexture(entry.Name);
+        GpuMemory::Get().OnDelete(entry.ObjectType, entry.Name);
+        break;
+    case Type::VertexArray:
+        GLCall(glDeleteVertexArrays(1, &entry.Name));
+        GLStateCache::Get().OnDeleteVertexArray(entry.Name);
+        break;
+    case Type::Program:
+        GLCall(glDeleteProgram(entry.Name));
+        GLStateCache::Get().OnDeleteProgram(entry.Name);
+        GpuMemory::Get().OnDelete(entry.ObjectType, entry.Name);
+        break;
+    }
+    m_Stats.Deleted++;
+}
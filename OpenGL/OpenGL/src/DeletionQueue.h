@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <mutex>
+
+//Deleting a GL object the GPU may still be reading from can make the driver wait for it in the middle of a frame.
+//Destructors hand their names to this queue instead. EndFrame puts a fence behind the names collected during
+//the frame, and they are deleted once that fence has signalled, a few frames later.
+//
+//Enqueue may be called from any thread. EndFrame and Flush need the context, so only the thread that renders calls them.
+class DeletionQueue
+{
+public:
+	enum class Type { Buffer, Texture, VertexArray, Program };
+
+	struct Stats
+	{
+		unsigned int QueueDepth = 0; //Names waiting to be deleted
+		unsigned long long DeferredBytes = 0; //GPU memory they still hold
+		unsigned int FramesInFlight = 0; //Fenced batches not yet signalled
+		unsigned long long Deleted = 0; //Names deleted so far
+	};
+private:
+	struct Entry
+	{
+		Type ObjectType;
+		unsigned int Name;
+		unsigned long long Bytes;
+	};
+
+	struct Batch
+	{
+		void* Fence; //GLsync
+		std::vector<Entry> Entries;
+	};
+
+	mutable std::mutex m_Mutex;
+	std::vector<Entry> m_Pending; //Enqueued since the last EndFrame
+	std::deque<Batch> m_Fenced; //Oldest first
+	bool m_Enabled;
+	Stats m_Stats;
+
+	DeletionQueue();
+public:
+	static DeletionQueue& Get();
+
+	void Enqueue(Type type, unsigned int name, unsigned long long bytes = 0); //Name 0 (moved-from objects) is ignored
+	//Call after the frame's last draw. Deletes the batches whose fence has signalled, never waits.
+	void EndFrame();
+	//Deletes everything now, e.g. before the context goes away
+	void Flush();
+
+	//Disabled, Enqueue deletes right away (the old behaviour). Enqueue then has to run on the rendering thread too.
+	void SetEnabled(bool enabled);
+	inline bool IsEnabled() const { return m_Enabled; }
+	Stats GetStats() const;
+private:
+	void Delete(const Entry& entry);
+	void Retire(Batch& batch);
+};
@@ -0,0 +1,149 @@
+#include "FileWatcher.h"
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+    #include <sys/inotify.h>
+    #include <poll.h>
+    #include <unistd.h>
+#endif
+
+#ifdef __linux__
+//"resources/shaders/Basic.shader" is "resources/shaders/" + "Basic.shader", "Basic.shader" is "" + "Basic.shader"
+static std::string GetPrefix(const std::string& path)
+{
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+#else
+static long long GetModifiedTime(const std::string& path)
+{
+#ifdef _MSC_VER
+    struct _stat64 info;
+    if (_stat64(path.c_str(), &info) != 0)
+        return -1;
+#else
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0)
+        return -1;
+#endif
+    //Seconds only: the size catches most of the saves made within the same second
+    return (long long)info.st_mtime * 1000003 + (long long)info.st_size;
+}
+#endif
+
+//milliseconds(PollMs) takes it by reference, which needs the constant to have storage
+const unsigned int FileWatcher::PollMs;
+
+FileWatcher::FileWatcher(Callback callback)
+    :m_Callback(callback), m_Quit(false)
+{
+#ifdef __linux__
+    m_Inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_Inotify < 0)
+        std::cout << "[FileWatcher] inotify is not available, nothing will be watched" << std::endl;
+#endif
+    m_Thread = std::thread(&FileWatcher::Run, this);
+}
+
+FileWatcher::~FileWatcher()
+{
+    m_Quit = true;
+    m_Thread.join();
+#ifdef __linux__
+    if (m_Inotify >= 0)
+        close(m_Inotify);
+#endif
+}
+
+void FileWatcher::Watch(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (m_Files[path]++ != 0)
+        return;
+#ifdef __linux__
+    std::string prefix = GetPrefix(path);
+    if (m_Inotify < 0 || m_DirectoryWatches.count(prefix))
+        return;
+    int watch = inotify_add_watch(m_Inotify, prefix.empty() ? "." : prefix.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (watch < 0)
+    {
+        std::cout << "[FileWatcher] Could not watch " << (prefix.empty() ? "." : prefix) << std::endl;
+        return;
+    }
+    //Watching the same directory again returns the same descriptor
+    m_Directories[watch] = prefix;
+    m_DirectoryWatches[prefix] = watch;
+#else
+    m_ModifiedTimes[path] = GetModifiedTime(path);
+#endif
+}
+
+void FileWatcher::Unwatch(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto it = m_Files.find(path);
+    if (it == m_Files.end() || --it->second != 0)
+        return;
+    m_Files.erase(it);
+#ifndef __linux__
+    m_ModifiedTimes.erase(path);
+#endif
+    //Directory watches stay, events for files nobody watches are dropped
+}
+
+void FileWatcher::Run()
+{
+    std::vector<std::string> changed;
+    while (!m_Quit)
+    {
+        changed.clear();
+#ifdef __linux__
+        if (m_Inotify < 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(PollMs));
+            continue;
+        }
+        pollfd descriptor = { m_Inotify, POLLIN, 0 };
+        if (poll(&descriptor, 1, PollMs) <= 0)
+            continue;
+
+        alignas(inotify_event) char buffer[4096];
+        ssize_t length;
+        while ((length = read(m_Inotify, buffer, sizeof(buffer))) > 0)
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            for (char* at = buffer; at < buffer + length; at += sizeof(inotify_event) + ((inotify_event*)at)->len)
+            {
+                const inotify_event* event = (const inotify_event*)at;
+                auto directory = m_Directories.find(event->wd);
+                if (event->len == 0 || directory == m_Directories.end())
+                    continue;
+                std::string path = directory->second + event->name;
+                if (m_Files.count(path))
+                    changed.push_back(path);
+            }
+        }
+#else
+        std::this_thread::sleep_for(std::chrono::milliseconds(PollMs));
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            for (auto& file : m_ModifiedTimes)
+            {
+                long long modified = GetModifiedTime(file.first);
+                if (modified != file.second && modified != -1)
+                {
+                    file.second = modified;
+                    changed.push_back(file.first);
+                }
+            }
+        }
+#endif
+        //Outside the lock, the callback may call Watch
+        for (const std::string& path : changed)
+            m_Callback(path);
+    }
+}
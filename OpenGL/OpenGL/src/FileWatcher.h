@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <functional>
+#include <unordered_map>
+#include <mutex>
+#include <thread>
+#include <atomic>
+
+//Calls back when a watched file has been written, from a thread of its own. On Linux it waits on inotify for the
+//file's directory, so editors that save by writing a new file and renaming it over the old one are seen as well.
+//Elsewhere it compares modification times a few times a second. A save can come as several writes: expect more
+//than one call and read the file each time.
+class FileWatcher
+{
+public:
+	using Callback = std::function<void(const std::string& path)>;
+	static const unsigned int PollMs = 50; //How long the thread sleeps before it looks for a stop, or checks times
+private:
+	Callback m_Callback;
+	std::mutex m_Mutex;
+	std::unordered_map<std::string, unsigned int> m_Files; //Path as given to Watch, to how many times it was
+	std::atomic<bool> m_Quit;
+#ifdef __linux__
+	int m_Inotify;
+	std::unordered_map<int, std::string> m_Directories; //Watch descriptor to the prefix of the paths in it
+	std::unordered_map<std::string, int> m_DirectoryWatches;
+#else
+	std::unordered_map<std::string, long long> m_ModifiedTimes;
+#endif
+	std::thread m_Thread;
+public:
+	FileWatcher(Callback callback);
+	~FileWatcher(); //Stops the thread, no call is made after this
+
+	FileWatcher(const FileWatcher&) = delete;
+	FileWatcher& operator=(const FileWatcher&) = delete;
+
+	void Watch(const std::string& path);
+	void Unwatch(const std::string& path);
+private:
+	void Run();
+};
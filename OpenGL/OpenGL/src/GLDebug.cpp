@@ -0,0 +1,147 @@
+#include "GLDebug.h"
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+#include <cstdint>
+
+struct Callsite
+{
+    const char* Function = nullptr;
+    const char* File = nullptr;
+    int Line = 0;
+    bool ErrorRaised = false; //Set by a synchronous callback during the call
+};
+
+//The callback runs on the thread that made the call when synchronous, on a driver thread otherwise
+static thread_local Callsite s_Callsite;
+static bool s_UsingCallback = false;
+static bool s_Synchronous = true;
+static unsigned int s_RateLimit = 5;
+static std::mutex s_ReportMutex;
+static std::unordered_map<uint64_t, unsigned int> s_ReportCounts;
+
+static bool ShouldReport(uint64_t site)
+{
+    std::lock_guard<std::mutex> lock(s_ReportMutex);
+    unsigned int& count = s_ReportCounts[site];
+    count++;
+    if (s_RateLimit == 0 || count <= s_RateLimit)
+        return true;
+    if (count == s_RateLimit + 1)
+        std::cout << "[OpenGL] Further reports from this site are muted" << std::endl;
+    return false;
+}
+
+static uint64_t CallsiteKey(const Callsite& callsite)
+{
+    //File names are string literals, so the pointer identifies the file
+    return ((uint64_t)(uintptr_t)callsite.File << 20) ^ (uint64_t)callsite.Line;
+}
+
+static const char* SeverityName(GLenum severity)
+{
+    switch (severity)
+    {
+        case GL_DEBUG_SEVERITY_HIGH:         return "high";
+        case GL_DEBUG_SEVERITY_MEDIUM:       return "medium";
+        case GL_DEBUG_SEVERITY_LOW:          return "low";
+        case GL_DEBUG_SEVERITY_NOTIFICATION: return "notification";
+    }
+    return "unknown";
+}
+
+static void GLAPIENTRY DebugCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei /*length*/, const GLchar* message, const void* /*userParam*/)
+{
+    bool isError = type == GL_DEBUG_TYPE_ERROR;
+    bool knowsCallsite = s_Synchronous && s_Callsite.File;
+    if (isError && knowsCallsite)
+        s_Callsite.ErrorRaised = true;
+
+    //Per callsite when we know it, per message ID otherwise (top bit keeps the two apart)
+    uint64_t site = knowsCallsite ? CallsiteKey(s_Callsite) : ((uint64_t)1 << 63) | ((uint64_t)source << 32) | id;
+    if (!ShouldReport(site))
+        return;
+
+    std::cout << "[OpenGL " << (isError ? "Error" : "Debug") << "] (" << SeverityName(severity) << ", " << id << ") " << message;
+    if (knowsCallsite)
+        std::cout << " " << s_Callsite.Function << " " << s_Callsite.File << " " << s_Callsite.Line;
+    std::cout << std::endl;
+}
+
+bool GLDebug::Init(bool synchronous, Severity minSeverity)
+{
+    s_UsingCallback = GLEW_VERSION_4_3 || GLEW_KHR_debug;
+    if (!s_UsingCallback)
+    {
+        std::cout << "[OpenGL] KHR_debug not available, checking glGetError after every call" << std::endl;
+        return false;
+    }
+
+    glEnable(GL_DEBUG_OUTPUT);
+    glDebugMessageCallback(DebugCallback, nullptr);
+    SetSynchronous(synchronous);
+    SetMinSeverity(minSeverity);
+    return true;
+}
+
+void GLDebug::SetSynchronous(bool synchronous)
+{
+    s_Synchronous = synchronous;
+    if (!s_UsingCallback)
+        return;
+    if (synchronous)
+        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    else
+        glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+}
+
+void GLDebug::SetMinSeverity(Severity minSeverity)
+{
+    if (!s_UsingCallback)
+        return;
+    const GLenum severities[] = { GL_DEBUG_SEVERITY_NOTIFICATION, GL_DEBUG_SEVERITY_LOW, GL_DEBUG_SEVERITY_MEDIUM, GL_DEBUG_SEVERITY_HIGH };
+    for (int i = 0; i < 4; i++)
+        glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, severities[i], 0, nullptr, i >= (int)minSeverity ? GL_TRUE : GL_FALSE);
+}
+
+void GLDebug::SetRateLimit(unsigned int reportsPerSite)
+{
+    std::lock_guard<std::mutex> lock(s_ReportMutex);
+    s_RateLimit = reportsPerSite;
+    s_ReportCounts.clear();
+}
+
+bool GLDebug::IsUsingCallback()
+{
+    return s_UsingCallback;
+}
+
+void GLDebug::SetCallsite(const char* function, const char* file, int line)
+{
+    s_Callsite.Function = function;
+    s_Callsite.File = file;
+    s_Callsite.Line = line;
+    s_Callsite.ErrorRaised = false;
+}
+
+bool GLDebug::CheckCall()
+{
+    if (s_UsingCallback)
+    {
+        //Nothing to ask the driver, the callback already ran if the call failed
+        bool ok = !s_Callsite.ErrorRaised;
+        s_Callsite = Callsite(); //Calls outside GLCall are reported without a callsite
+        return ok;
+    }
+
+    //Fallback: errors from unchecked calls since the last check end up here as well
+    bool ok = true;
+    while (GLenum error = glGetError())
+    {
+        ok = false;
+        if (ShouldReport(CallsiteKey(s_Callsite)))
+            std::cout << "[OpenGL Error] (" << error << ")" << s_Callsite.Function << " " << s_Callsite.File << " " << s_Callsite.Line << std::endl;
+    }
+    s_Callsite = Callsite();
+    return ok;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#ifdef _MSC_VER
+    #define DEBUG_BREAK() __debugbreak()
+#else
+    #include <csignal>
+    #define DEBUG_BREAK() raise(SIGTRAP)
+#endif
+
+#define ASSERT(x) if (!(x)) DEBUG_BREAK();
+
+//DEBUG: full checks. GL_CHECKS: the same checks for release builds, cheap once KHR_debug is in use.
+#if defined(DEBUG) || defined(GL_CHECKS)
+    #define GL_CHECKS_ENABLED
+#endif
+
+#ifdef GL_CHECKS_ENABLED
+    #define GLCall(x) GLDebug::SetCallsite(#x, __FILE__, __LINE__);\
+            x;\
+            ASSERT(GLDebug::CheckCall())
+#else
+    #define GLCall(x) x;
+#endif
+
+//Error reporting for GLCall. With KHR_debug (GL 4.3) the driver reports errors through a callback
+//and GLCall only records where it is; glGetError after every call is the fallback for older contexts.
+//Reports are rate limited per callsite, so an error inside the frame loop doesn't flood the log.
+class GLDebug
+{
+public:
+	enum class Severity { Notification = 0, Low, Medium, High };
+
+	//Call once the context is current and GLEW is initialized. Returns true when the callback is in use.
+	//Synchronous makes the driver report errors inside the failing call, so GLCall knows the callsite
+	//and can break on it. Asynchronous is cheaper but only logs, without a callsite.
+	static bool Init(bool synchronous = true, Severity minSeverity = Severity::Low);
+
+	static void SetSynchronous(bool synchronous);
+	static void SetMinSeverity(Severity minSeverity); //Messages below this are dropped by the driver
+	static void SetRateLimit(unsigned int reportsPerSite); //0 = no limit
+
+	static bool IsUsingCallback();
+
+	//Used by GLCall
+	static void SetCallsite(const char* function, const char* file, int line);
+	static bool CheckCall();
+};
@@ -0,0 +1,164 @@
+#include "GLStateCache.h"
+#include "Renderer.h"
+#include "GpuMemory.h"
+
+//Names are never 0xffffffff, so this forces the first bind of every kind through
+static const unsigned int s_Unknown = GLStateCache::Unknown;
+
+GLStateCache::GLStateCache()
+{
+    Invalidate();
+}
+
+GLStateCache& GLStateCache::Get()
+{
+    thread_local GLStateCache cache;
+    return cache;
+}
+
+void GLStateCache::UseProgram(unsigned int program)
+{
+    if (m_Program == program)
+    {
+        m_Stats.Skipped++;
+        return;
+    }
+    GLCall(glUseProgram(program));
+    m_Program = program;
+    m_Stats.Issued++;
+}
+
+void GLStateCache::BindVertexArray(unsigned int vertexArray)
+{
+    if (m_VertexArray == vertexArray)
+    {
+        m_Stats.Skipped++;
+        return;
+    }
+    GLCall(glBindVertexArray(vertexArray));
+    m_VertexArray = vertexArray;
+    m_Stats.Issued++;
+    m_Stats.VertexArrayBinds++;
+}
+
+void GLStateCache::BindBuffer(unsigned int target, unsigned int buffer)
+{
+    unsigned int* cached = nullptr;
+    if (target == GL_ARRAY_BUFFER)
+        cached = &m_ArrayBuffer;
+    else if (target == GL_ELEMENT_ARRAY_BUFFER && m_VertexArray != s_Unknown)
+    {
+        auto it = m_ElementBuffers.find(m_VertexArray);
+        if (it == m_ElementBuffers.end())
+            it = m_ElementBuffers.insert({ m_VertexArray, s_Unknown }).first;
+        cached = &it->second;
+    }
+
+    if (cached && *cached == buffer)
+    {
+        m_Stats.Skipped++;
+        return;
+    }
+    GLCall(glBindBuffer(target, buffer));
+    if (cached)
+        *cached = buffer;
+    m_Stats.Issued++;
+}
+
+void GLStateCache::ActiveTexture(unsigned int unit)
+{
+    if (m_ActiveTextureUnit == unit)
+    {
+        m_Stats.Skipped++;
+        return;
+    }
+    GLCall(glActiveTexture(GL_TEXTURE0 + unit));
+    m_ActiveTextureUnit = unit;
+    m_Stats.Issued++;
+}
+
+void GLStateCache::BindTexture(unsigned int unit, unsigned int texture)
+{
+    ASSERT(unit < MaxTextureUnits);
+    if (m_Textures[unit] == texture)
+    {
+        m_Stats.Skipped++;
+        return;
+    }
+    ActiveTexture(unit);
+    GLCall(glBindTexture(GL_TEXTURE_2D, texture));
+    m_Textures[unit] = texture;
+    m_Stats.Issued++;
+}
+
+void GLStateCache::BindUniformBuffer(unsigned int index, unsigned int buffer, unsigned int offset, unsigned int size)
+{
+    BufferRange* cached = index < MaxUniformBufferBindings ? &m_UniformBuffers[index] : nullptr;
+    if (cached && cached->Buffer == buffer && cached->Offset == offset && cached->Size == size)
+    {
+        m_Stats.Skipped++;
+        return;
+    }
+    GLCall(glBindBufferRange(GL_UNIFORM_BUFFER, index, buffer, offset, size));
+    if (cached)
+        *cached = { buffer, offset, size };
+    m_Stats.Issued++;
+}
+
+void GLStateCache::OnDeleteProgram(unsigned int program)
+{
+    if (m_Program == program)
+        m_Program = s_Unknown;
+}
+
+void GLStateCache::OnDeleteVertexArray(unsigned int vertexArray)
+{
+    if (m_VertexArray == vertexArray)
+        m_VertexArray = 0;
+    m_ElementBuffers.erase(vertexArray);
+}
+
+void GLStateCache::OnDeleteBuffer(unsigned int buffer)
+{
+    if (m_ArrayBuffer == buffer)
+        m_ArrayBuffer = 0;
+    //GL only detaches it from the bound VAO, forgetting it for every VAO is the safe side
+    for (auto& elementBuffer : m_ElementBuffers)
+    {
+        if (elementBuffer.second == buffer)
+            elementBuffer.second = s_Unknown;
+    }
+    for (unsigned int i = 0; i < MaxUniformBufferBindings; i++)
+    {
+        if (m_UniformBuffers[i].Buffer == buffer)
+            m_UniformBuffers[i].Buffer = 0;
+    }
+}
+
+void GLStateCache::OnDeleteTexture(unsigned int texture)
+{
+    for (unsigned int i = 0; i < MaxTextureUnits; i++)
+    {
+        if (m_Textures[i] == texture)
+            m_Textures[i] = 0;
+    }
+}
+
+void GLStateCache::Invalidate()
+{
+    m_Program = s_Unknown;
+    m_VertexArray = s_Unknown;
+    m_ArrayBuffer = s_Unknown;
+    m_ActiveTextureUnit = s_Unknown;
+    for (unsigned int i = 0; i < MaxTextureUnits; i++)
+        m_Textures[i] = s_Unknown;
+    for (unsigned int i = 0; i < MaxUniformBufferBindings; i++)
+        m_UniformBuffers[i].Buffer = s_Unknown;
+    m_ElementBuffers.clear();
+}
+
+void GLStateCache::OnUpload(unsigned long long bytes)
+{
+    m_Stats.BytesUploaded += bytes;
+    GpuMemory::Get().OnUpload(bytes);
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <unordered_map>
+
+//Shadow copy of the GL binding state so Bind() calls that would not change anything never reach the driver.
+//A context is current on one thread at a time, so there is one cache per thread (Get()).
+//Every resource class binds through here. Code that changes bindings behind its back must call Invalidate().
+class GLStateCache
+{
+public:
+	static const unsigned int MaxTextureUnits = 32;
+	static const unsigned int MaxUniformBufferBindings = 16; //Binding points above this are not cached
+	static const unsigned int Unknown = 0xffffffff; //What GetProgram returns when the cache doesn't know the binding
+
+	//Every bind passes through here, so the cache also keeps the other per-frame GL counters
+	struct Stats
+	{
+		unsigned int Issued = 0;
+		unsigned int Skipped = 0;
+		unsigned int VertexArrayBinds = 0; //Part of Issued
+		unsigned int DrawCalls = 0;
+		unsigned long long BytesUploaded = 0; //Buffer and texture data sent to the GL
+	};
+private:
+	unsigned int m_Program;
+	unsigned int m_VertexArray;
+	unsigned int m_ArrayBuffer;
+	unsigned int m_ActiveTextureUnit;
+	unsigned int m_Textures[MaxTextureUnits];
+	struct BufferRange
+	{
+		unsigned int Buffer;
+		unsigned int Offset;
+		unsigned int Size;
+	};
+	BufferRange m_UniformBuffers[MaxUniformBufferBindings]; //glBindBufferRange(GL_UNIFORM_BUFFER, index, ...)
+	//The element buffer binding is part of the vertex array object, so remember it per VAO
+	std::unordered_map<unsigned int, unsigned int> m_ElementBuffers;
+	Stats m_Stats;
+public:
+	GLStateCache();
+
+	static GLStateCache& Get();
+
+	void UseProgram(unsigned int program);
+	inline unsigned int GetProgram() const { return m_Program; }
+	void BindVertexArray(unsigned int vertexArray);
+	void BindBuffer(unsigned int target, unsigned int buffer);
+	void ActiveTexture(unsigned int unit);
+	void BindTexture(unsigned int unit, unsigned int texture); //GL_TEXTURE_2D on the given unit
+	//Also binds the buffer to GL_UNIFORM_BUFFER itself, which isn't tracked
+	void BindUniformBuffer(unsigned int index, unsigned int buffer, unsigned int offset, unsigned int size);
+
+	//GL drops bindings of deleted objects and may hand the name out again
+	void OnDeleteProgram(unsigned int program);
+	void OnDeleteVertexArray(unsigned int vertexArray);
+	void OnDeleteBuffer(unsigned int buffer);
+	void OnDeleteTexture(unsigned int texture);
+
+	void Invalidate(); //Forget everything, the next bind of each kind goes to the driver
+
+	inline void OnDraw(unsigned int drawCalls = 1) { m_Stats.DrawCalls += drawCalls; }
+	void OnUpload(unsigned long long bytes); //Also counted in GpuMemory's per-frame upload volume
+
+	inline const Stats& GetStats() const { return m_Stats; }
+	inline void ResetStats() { m_Stats = Stats(); } //Call once per frame
+};
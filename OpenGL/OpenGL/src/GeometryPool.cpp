@@ -0,0 +1,217 @@
+#include "GeometryPool.h"
+#include "Renderer.h"
+#include "GLStateCache.h"
+#include "Profiler.h"
+#include "DeletionQueue.h"
+#include "GpuMemory.h"
+#include <algorithm>
+#include <iostream>
+
+RangeAllocator::RangeAllocator(unsigned int capacity)
+    :m_Capacity(capacity), m_Used(0)
+{
+    Reset(0);
+}
+
+unsigned int RangeAllocator::Allocate(unsigned int size)
+{
+    if (size == 0)
+        return Invalid;
+    for (auto it = m_FreeRanges.begin(); it != m_FreeRanges.end(); ++it)
+    {
+        if (it->second < size)
+            continue;
+        unsigned int offset = it->first;
+        unsigned int left = it->second - size;
+        m_FreeRanges.erase(it);
+        if (left > 0)
+            m_FreeRanges[offset + size] = left;
+        m_Used += size;
+        return offset;
+    }
+    return Invalid;
+}
+
+void RangeAllocator::Free(unsigned int offset, unsigned int size)
+{
+    m_Used -= size;
+    auto next = m_FreeRanges.lower_bound(offset);
+    //Merge with the free range right after it
+    if (next != m_FreeRanges.end() && offset + size == next->first)
+    {
+        size += next->second;
+        next = m_FreeRanges.erase(next);
+    }
+    //and with the one right before it
+    if (next != m_FreeRanges.begin())
+    {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == offset)
+        {
+            previous->second += size;
+            return;
+        }
+    }
+    m_FreeRanges[offset] = size;
+}
+
+void RangeAllocator::Reset(unsigned int used)
+{
+    m_FreeRanges.clear();
+    m_Used = used;
+    if (used < m_Capacity)
+        m_FreeRanges[used] = m_Capacity - used;
+}
+
+unsigned int RangeAllocator::GetLargestFreeRange() const
+{
+    unsigned int largest = 0;
+    for (const auto& range : m_FreeRanges)
+        largest = std::max(largest, range.second);
+    return largest;
+}
+
+GeometryPool::GeometryPool(const VertexBufferLayout& layout, unsigned int maxVertices, unsigned int maxIndices)
+    :m_Layout(layout), m_VertexBuffer(maxVertices * layout.GetStride()), m_IndexBuffer(maxIndices, maxVertices - 1),
+    m_Vertices(maxVertices), m_Indices(maxIndices)
+{
+    m_VertexArray.AddBuffer(m_VertexBuffer, m_Layout);
+}
+
+unsigned int GeometryPool::AddMesh(const void* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount)
+{
+    PROFILE_SCOPE("GeometryPool::AddMesh");
+    unsigned int baseVertex = m_Vertices.Allocate(vertexCount);
+    unsigned int firstIndex = m_Indices.Allocate(indexCount);
+    if (baseVertex == RangeAllocator::Invalid || firstIndex == RangeAllocator::Invalid)
+    {
+        if (baseVertex != RangeAllocator::Invalid)
+            m_Vertices.Free(baseVertex, vertexCount);
+        if (firstIndex != RangeAllocator::Invalid)
+            m_Indices.Free(firstIndex, indexCount);
+
+        //Enough room in total but no single range large enough: close the gaps and try once more
+        bool fits = m_Vertices.GetUsed() + vertexCount <= m_Vertices.GetCapacity() && m_Indices.GetUsed() + indexCount <= m_Indices.GetCapacity();
+        if (!fits || vertexCount == 0 || indexCount == 0)
+        {
+            std::cout << "[GeometryPool] No room for a mesh of " << vertexCount << " vertices and " << indexCount << " indices" << std::endl;
+            return InvalidMesh;
+        }
+        Compact();
+        baseVertex = m_Vertices.Allocate(vertexCount);
+        firstIndex = m_Indices.Allocate(indexCount);
+    }
+
+    if (!m_VertexBuffer.SetData(vertices, vertexCount * m_Layout.GetStride(), baseVertex * m_Layout.GetStride()) ||
+        !m_IndexBuffer.SetData(indices, indexCount, firstIndex))
+    {
+        //The pool's storage was refused by GpuMemory, there is nothing to draw the mesh from
+        m_Vertices.Free(baseVertex, vertexCount);
+        m_Indices.Free(firstIndex, indexCount);
+        return InvalidMesh;
+    }
+
+    unsigned int mesh;
+    if (!m_FreeIDs.empty())
+    {
+        mesh = m_FreeIDs.back();
+        m_FreeIDs.pop_back();
+    }
+    else
+    {
+        mesh = (unsigned int)m_Meshes.size();
+        m_Meshes.push_back({});
+        m_Live.push_back(false);
+    }
+    m_Meshes[mesh] = { baseVertex, vertexCount, firstIndex, indexCount };
+    m_Live[mesh] = true;
+    return mesh;
+}
+
+void GeometryPool::RemoveMesh(unsigned int mesh)
+{
+    if (mesh >= m_Meshes.size() || !m_Live[mesh])
+    {
+        std::cout << "[GeometryPool] RemoveMesh: " << mesh << " is not a mesh of this pool" << std::endl;
+        return;
+    }
+    const Mesh& range = m_Meshes[mesh];
+    m_Vertices.Free(range.BaseVertex, range.VertexCount);
+    m_Indices.Free(range.FirstIndex, range.IndexCount);
+    m_Live[mesh] = false;
+    m_FreeIDs.push_back(mesh);
+}
+
+void GeometryPool::Compact()
+{
+    PROFILE_GPU_SCOPE("GeometryPool::Compact");
+    CompactBuffer(m_VertexBuffer.GetRendererID(), m_Layout.GetStride(), m_Vertices, &Mesh::BaseVertex, &Mesh::VertexCount);
+    //Indices are relative to BaseVertex, so they move as they are
+    CompactBuffer(m_IndexBuffer.GetRendererID(), m_IndexBuffer.GetTypeSize(), m_Indices, &Mesh::FirstIndex, &Mesh::IndexCount);
+}
+
+void GeometryPool::CompactBuffer(unsigned int buffer, unsigned int elementSize, RangeAllocator& allocator, unsigned int Mesh::*offset, unsigned int Mesh::*count)
+{
+    std::vector<unsigned int> order;
+    for (unsigned int i = 0; i < m_Meshes.size(); i++)
+    {
+        if (m_Live[i])
+            order.push_back(i);
+    }
+    std::sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b) { return m_Meshes[a].*offset < m_Meshes[b].*offset; });
+
+    unsigned int used = allocator.GetUsed();
+    unsigned int packed = 0;
+    for (unsigned int mesh : order)
+    {
+        if (m_Meshes[mesh].*offset != packed)
+            break;
+        packed += m_Meshes[mesh].*count;
+    }
+    if (packed == used)
+    {
+        //Already packed, only the free list may still have pieces to merge
+        allocator.Reset(used);
+        return;
+    }
+
+    //Source and destination ranges of one copy may not overlap within a buffer, so go through a scratch buffer:
+    //pack into it range by range, then copy it back to the start in one go
+    unsigned int scratch;
+    GLCall(glGenBuffers(1, &scratch));
+    GpuMemory::Get().Allocate(GpuMemory::Category::Other, scratch, used * elementSize, "GeometryPool compaction", false);
+    GLStateCache::Get().BindBuffer(GL_COPY_READ_BUFFER, buffer);
+    GLStateCache::Get().BindBuffer(GL_COPY_WRITE_BUFFER, scratch);
+    GLCall(glBufferData(GL_COPY_WRITE_BUFFER, used * elementSize, nullptr, GL_STREAM_COPY));
+
+    packed = 0;
+    for (unsigned int mesh : order)
+    {
+        Mesh& range = m_Meshes[mesh];
+        GLCall(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, range.*offset * elementSize, packed * elementSize, range.*count * elementSize));
+        range.*offset = packed;
+        packed += range.*count;
+    }
+
+    GLStateCache::Get().BindBuffer(GL_COPY_READ_BUFFER, scratch);
+    GLStateCache::Get().BindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    GLCall(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, used * elementSize));
+    //The copies are still queued on the GPU
+    DeletionQueue::Get().Enqueue(DeletionQueue::Type::Buffer, scratch, used * elementSize);
+
+    allocator.Reset(used);
+}
+
+GeometryPool::Stats GeometryPool::GetStats() const
+{
+    Stats stats;
+    stats.MeshCount = (unsigned int)(m_Meshes.size() - m_FreeIDs.size());
+    stats.VerticesUsed = m_Vertices.GetUsed();
+    stats.VertexCapacity = m_Vertices.GetCapacity();
+    stats.VertexFreeRanges = m_Vertices.GetFreeRangeCount();
+    stats.LargestFreeVertexRange = m_Vertices.GetLargestFreeRange();
+    stats.IndicesUsed = m_Indices.GetUsed();
+    stats.IndexCapacity = m_Indices.GetCapacity();
+    stats.IndexFreeRanges = m_Indices.GetFreeRangeCount();
+    return stats;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <map>
+#include <vector>
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "VertexBufferLayout.h"
+#include "IndexBuffer.h"
+
+//First-fit free list over [0, capacity) in arbitrary units, neighbouring free ranges are merged on Free
+class RangeAllocator
+{
+private:
+	std::map<unsigned int, unsigned int> m_FreeRanges; //Offset -> size
+	unsigned int m_Capacity;
+	unsigned int m_Used;
+public:
+	static const unsigned int Invalid = 0xffffffff;
+
+	RangeAllocator(unsigned int capacity);
+
+	unsigned int Allocate(unsigned int size); //Offset, or Invalid when no free range is large enough
+	void Free(unsigned int offset, unsigned int size);
+	void Reset(unsigned int used); //Everything below used is allocated, the rest is one free range
+
+	unsigned int GetLargestFreeRange() const;
+	inline unsigned int GetFreeRangeCount() const { return (unsigned int)m_FreeRanges.size(); }
+	inline unsigned int GetUsed() const { return m_Used; }
+	inline unsigned int GetCapacity() const { return m_Capacity; }
+};
+
+//Packs many meshes of one vertex layout into a single vertex buffer and index buffer behind one vertex array.
+//Drawing a mesh is a glDrawElementsBaseVertex at its ranges, so meshes can be drawn back to back without
+//any vertex array or buffer binds in between. Indices stay local to each mesh (0 = its first vertex).
+//
+//Mesh IDs stay valid until RemoveMesh. Compact moves the meshes together to undo fragmentation,
+//their ranges change but their IDs don't.
+class GeometryPool
+{
+public:
+	static const unsigned int InvalidMesh = 0xffffffff;
+
+	struct Mesh
+	{
+		unsigned int BaseVertex;
+		unsigned int VertexCount;
+		unsigned int FirstIndex;
+		unsigned int IndexCount;
+	};
+
+	struct Stats
+	{
+		unsigned int MeshCount = 0;
+		unsigned int VerticesUsed = 0, VertexCapacity = 0, VertexFreeRanges = 0;
+		unsigned int IndicesUsed = 0, IndexCapacity = 0, IndexFreeRanges = 0;
+		unsigned int LargestFreeVertexRange = 0;
+	};
+private:
+	VertexBufferLayout m_Layout;
+	VertexArray m_VertexArray;
+	VertexBuffer m_VertexBuffer;
+	IndexBuffer m_IndexBuffer;
+	RangeAllocator m_Vertices;
+	RangeAllocator m_Indices;
+
+	std::vector<Mesh> m_Meshes;
+	std::vector<bool> m_Live;
+	std::vector<unsigned int> m_FreeIDs;
+public:
+	//Indices are 16-bit (8-bit) when maxVertices is at most 65536 (256)
+	GeometryPool(const VertexBufferLayout& layout, unsigned int maxVertices, unsigned int maxIndices);
+
+	//vertices in the pool's layout. Returns InvalidMesh when the pool has no room left, even after Compact,
+	//or when GpuMemory refused its buffers
+	unsigned int AddMesh(const void* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount);
+	void RemoveMesh(unsigned int mesh);
+
+	//Moves all meshes to the start of the buffers, in their current order. GPU-side copies only.
+	void Compact();
+
+	inline const Mesh& GetMesh(unsigned int mesh) const { return m_Meshes[mesh]; }
+	inline const VertexArray& GetVertexArray() const { return m_VertexArray; }
+	inline const IndexBuffer& GetIndexBuffer() const { return m_IndexBuffer; }
+	Stats GetStats() const;
+private:
+	void CompactBuffer(unsigned int buffer, unsigned int elementSize, RangeAllocator& allocator, unsigned int Mesh::*offset, unsigned int Mesh::*count);
+};
@@ -0,0 +1,302 @@
+#include "GpuMemory.h"
+#include "imgui/imgui.h"
+#include <iostream>
+#include <algorithm>
+#include <cstdio>
+#include <cfloat>
+
+static std::string FormatBytes(unsigned long long bytes)
+{
+    char text[32];
+    if (bytes >= 1024ull * 1024 * 1024)
+        snprintf(text, sizeof(text), "%.2f GB", bytes / (1024.0 * 1024.0 * 1024.0));
+    else if (bytes >= 1024ull * 1024)
+        snprintf(text, sizeof(text), "%.2f MB", bytes / (1024.0 * 1024.0));
+    else if (bytes >= 1024ull)
+        snprintf(text, sizeof(text), "%.1f KB", bytes / 1024.0);
+    else
+        snprintf(text, sizeof(text), "%llu B", bytes);
+    return text;
+}
+
+GpuMemory::GpuMemory()
+    :m_Deferred(0), m_FrameUploaded(0), m_LastFrameUploaded(0), m_PeakFrameUploaded(0)
+{
+}
+
+GpuMemory::~GpuMemory()
+{
+    ReportLeaks();
+}
+
+GpuMemory& GpuMemory::Get()
+{
+    static GpuMemory memory;
+    return memory;
+}
+
+const char* GpuMemory::GetCategoryName(Category category)
+{
+    switch (category)
+    {
+        case Category::VertexBuffer: return "Vertex buffers";
+        case Category::IndexBuffer:  return "Index buffers";
+        case Category::StreamBuffer: return "Stream buffers";
+        case Category::Texture:      return "Textures";
+        case Category::Program:      return "Programs";
+        default:                     return "Other";
+    }
+}
+
+bool GpuMemory::Allocate(Category category, unsigned int name, unsigned long long bytes, const std::string& label, bool refusable)
+{
+    if (name == 0)
+        return false;
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    //Storage respecified (glBufferData again on the same name) replaces the old size, it isn't added to it
+    unsigned long long key = Key(GetObjectType(category), name);
+    auto existing = m_Allocations.find(key);
+    unsigned long long replaced = existing != m_Allocations.end() ? existing->second.Bytes : 0;
+    unsigned long long categoryCurrent = m_Categories[(int)category].Current;
+    if (existing != m_Allocations.end() && existing->second.ObjectCategory == category)
+        categoryCurrent -= replaced;
+    unsigned long long totalCurrent = m_Total.Current - replaced;
+
+    const Budget& budget = m_Budgets[(int)category];
+    bool overCategory = IsOverBudget(budget, categoryCurrent, bytes);
+    bool overTotal = IsOverBudget(m_TotalBudget, totalCurrent, bytes);
+    bool refuse = refusable && ((overCategory && budget.Action == BudgetAction::Refuse) || (overTotal && m_TotalBudget.Action == BudgetAction::Refuse));
+    if (refuse)
+    {
+        std::cout << "[GpuMemory] Refused " << FormatBytes(bytes) << " for " << GetLabelKey(category, label) << ": "
+            << (overCategory ? GetCategoryName(category) : "total") << " budget is " << FormatBytes(overCategory ? budget.Bytes : m_TotalBudget.Bytes)
+            << ", " << FormatBytes(overCategory ? m_Categories[(int)category].Current : m_Total.Current) << " in use" << std::endl;
+        return false;
+    }
+    //Warn when crossing, not on every allocation past the line
+    if (overCategory && categoryCurrent <= budget.Bytes)
+        std::cout << "[GpuMemory] " << GetCategoryName(category) << " over budget: " << FormatBytes(categoryCurrent + bytes)
+            << " of " << FormatBytes(budget.Bytes) << " after " << GetLabelKey(category, label) << std::endl;
+    if (overTotal && totalCurrent <= m_TotalBudget.Bytes)
+        std::cout << "[GpuMemory] Total over budget: " << FormatBytes(totalCurrent + bytes) << " of " << FormatBytes(m_TotalBudget.Bytes)
+            << " after " << GetLabelKey(category, label) << std::endl;
+
+    if (existing != m_Allocations.end())
+    {
+        Untrack(existing->second);
+        m_Allocations.erase(existing);
+    }
+
+    m_Allocations[key] = { category, bytes, label, false };
+    Add(m_Categories[(int)category], bytes);
+    Add(m_Total, bytes);
+    Add(m_Labels[GetLabelKey(category, label)], bytes);
+    return true;
+}
+
+void GpuMemory::SetLabel(Category category, unsigned int name, const std::string& label)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto it = m_Allocations.find(Key(GetObjectType(category), name));
+    if (it == m_Allocations.end())
+        return;
+    Allocation& allocation = it->second;
+    RemoveLabel(allocation);
+    allocation.Label = label;
+    Add(m_Labels[GetLabelKey(allocation.ObjectCategory, allocation.Label)], allocation.Bytes);
+}
+
+void GpuMemory::OnRelease(DeletionQueue::Type type, unsigned int name)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto it = m_Allocations.find(Key(type, name));
+    if (it == m_Allocations.end() || it->second.Released)
+        return;
+    it->second.Released = true;
+    m_Deferred += it->second.Bytes;
+}
+
+void GpuMemory::OnDelete(DeletionQueue::Type type, unsigned int name)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto it = m_Allocations.find(Key(type, name));
+    if (it == m_Allocations.end())
+        return;
+    Untrack(it->second);
+    m_Allocations.erase(it);
+}
+
+void GpuMemory::OnUpload(unsigned long long bytes)
+{
+    m_FrameUploaded += bytes;
+}
+
+void GpuMemory::EndFrame()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_LastFrameUploaded = m_FrameUploaded.exchange(0);
+    m_PeakFrameUploaded = std::max(m_PeakFrameUploaded, m_LastFrameUploaded);
+    m_UploadHistory.push_back((float)m_LastFrameUploaded);
+    if (m_UploadHistory.size() > HistorySize)
+        m_UploadHistory.pop_front();
+}
+
+void GpuMemory::SetBudget(Category category, unsigned long long bytes, BudgetAction action)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Budgets[(int)category] = { bytes, action };
+}
+
+void GpuMemory::SetTotalBudget(unsigned long long bytes, BudgetAction action)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_TotalBudget = { bytes, action };
+}
+
+GpuMemory::Usage GpuMemory::GetUsage(Category category) const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Categories[(int)category];
+}
+
+GpuMemory::Usage GpuMemory::GetTotalUsage() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Total;
+}
+
+unsigned long long GpuMemory::GetDeferredBytes() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Deferred;
+}
+
+unsigned int GpuMemory::ReportLeaks() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    std::unordered_map<std::string, Usage> leaks;
+    unsigned int count = 0;
+    unsigned long long bytes = 0;
+    for (const auto& entry : m_Allocations)
+    {
+        const Allocation& allocation = entry.second;
+        if (allocation.Released)
+            continue;
+        Usage& usage = leaks[GetLabelKey(allocation.ObjectCategory, allocation.Label)];
+        usage.Current += allocation.Bytes;
+        usage.Allocations++;
+        count++;
+        bytes += allocation.Bytes;
+    }
+    if (count == 0)
+        return 0;
+
+    std::vector<std::pair<std::string, Usage>> sorted(leaks.begin(), leaks.end());
+    std::sort(sorted.begin(), sorted.end(), [](const std::pair<std::string, Usage>& a, const std::pair<std::string, Usage>& b) { return a.second.Current > b.second.Current; });
+    std::cout << "[GpuMemory] " << count << " objects, " << FormatBytes(bytes) << ", were never released:" << std::endl;
+    for (const auto& leak : sorted)
+        std::cout << "    " << leak.first << ": " << leak.second.Allocations << " objects, " << FormatBytes(leak.second.Current) << std::endl;
+    return count;
+}
+
+void GpuMemory::OnImGuiRender()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    ImGui::Begin("GPU memory");
+
+    ImGui::Text("Total %s, peak %s, %u objects", FormatBytes(m_Total.Current).c_str(), FormatBytes(m_Total.Peak).c_str(), m_Total.Allocations);
+    if (m_TotalBudget.Bytes)
+    {
+        std::string overlay = FormatBytes(m_Total.Current) + " / " + FormatBytes(m_TotalBudget.Bytes);
+        ImGui::ProgressBar(std::min(1.0f, (float)((double)m_Total.Current / m_TotalBudget.Bytes)), ImVec2(-1.0f, 0.0f), overlay.c_str());
+    }
+    ImGui::Text("Waiting for deletion %s", FormatBytes(m_Deferred).c_str());
+    ImGui::Separator();
+
+    for (int category = 0; category < (int)Category::Count; category++)
+    {
+        const Usage& usage = m_Categories[category];
+        const Budget& budget = m_Budgets[category];
+        ImGui::Text("%-15s %10s  peak %10s  %5u objects", GetCategoryName((Category)category), FormatBytes(usage.Current).c_str(),
+            FormatBytes(usage.Peak).c_str(), usage.Allocations);
+        if (budget.Bytes)
+        {
+            ImGui::SameLine();
+            ImGui::Text(" budget %s (%s)", FormatBytes(budget.Bytes).c_str(), budget.Action == BudgetAction::Refuse ? "refuse" : "warn");
+        }
+    }
+    ImGui::Separator();
+
+    ImGui::Text("Uploaded last frame %s, peak %s", FormatBytes(m_LastFrameUploaded).c_str(), FormatBytes(m_PeakFrameUploaded).c_str());
+    if (!m_UploadHistory.empty())
+    {
+        std::vector<float> history(m_UploadHistory.begin(), m_UploadHistory.end());
+        ImGui::PlotLines("Bytes per frame", history.data(), (int)history.size(), 0, nullptr, 0.0f, FLT_MAX, ImVec2(0.0f, 60.0f));
+    }
+
+    if (ImGui::CollapsingHeader("By label"))
+    {
+        std::vector<std::pair<std::string, Usage>> labels(m_Labels.begin(), m_Labels.end());
+        std::sort(labels.begin(), labels.end(), [](const std::pair<std::string, Usage>& a, const std::pair<std::string, Usage>& b) { return a.second.Current > b.second.Current; });
+        for (const auto& label : labels)
+            ImGui::Text("%10s  peak %10s  x%u  %s", FormatBytes(label.second.Current).c_str(), FormatBytes(label.second.Peak).c_str(),
+                label.second.Allocations, label.first.c_str());
+    }
+    ImGui::End();
+}
+
+unsigned long long GpuMemory::Key(DeletionQueue::Type type, unsigned int name)
+{
+    return ((unsigned long long)type << 32) | name;
+}
+
+DeletionQueue::Type GpuMemory::GetObjectType(Category category)
+{
+    switch (category)
+    {
+        case Category::Texture: return DeletionQueue::Type::Texture;
+        case Category::Program: return DeletionQueue::Type::Program;
+        default:                return DeletionQueue::Type::Buffer;
+    }
+}
+
+std::string GpuMemory::GetLabelKey(Category category, const std::string& label) const
+{
+    return label.empty() ? std::string("(") + GetCategoryName(category) + ", unlabelled)" : label;
+}
+
+bool GpuMemory::IsOverBudget(const Budget& budget, unsigned long long current, unsigned long long bytes) const
+{
+    return budget.Bytes != 0 && current + bytes > budget.Bytes;
+}
+
+void GpuMemory::Untrack(const Allocation& allocation)
+{
+    if (allocation.Released)
+        m_Deferred -= allocation.Bytes;
+    Remove(m_Categories[(int)allocation.ObjectCategory], allocation.Bytes);
+    Remove(m_Total, allocation.Bytes);
+    RemoveLabel(allocation);
+}
+
+void GpuMemory::RemoveLabel(const Allocation& allocation)
+{
+    std::string labelKey = GetLabelKey(allocation.ObjectCategory, allocation.Label);
+    Usage& usage = m_Labels[labelKey];
+    Remove(usage, allocation.Bytes);
+    if (usage.Allocations == 0)
+        m_Labels.erase(labelKey);
+}
+
+void GpuMemory::Add(Usage& usage, unsigned long long bytes)
+{
+    usage.Current += bytes;
+    usage.Peak = std::max(usage.Peak, usage.Current);
+    usage.Allocations++;
+}
+
+void GpuMemory::Remove(Usage& usage, unsigned long long bytes)
+{
+    usage.Current -= bytes;
+    usage.Allocations--;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include "DeletionQueue.h"
+
+//Video memory taken by the renderer's GL objects: bytes per category and per label, current and peak, and the
+//volume uploaded per frame. Sizes are what was asked of the driver (buffer sizes, width x height x bytes per texel),
+//the driver's own padding and alignment come on top.
+//An allocation counts until the object is actually deleted, so names still waiting in the DeletionQueue count too
+//(as deferred). Budgets per category and in total either warn when crossed or make Allocate refuse, in which case
+//the resource comes out empty. Objects never released by their owner are listed when the tracker goes away.
+class GpuMemory
+{
+public:
+	enum class Category { VertexBuffer = 0, IndexBuffer, StreamBuffer, Texture, Program, Other, Count };
+	enum class BudgetAction { Warn, Refuse };
+
+	static const unsigned int HistorySize = 120; //Frames of upload volume kept for the panel
+
+	struct Usage
+	{
+		unsigned long long Current = 0;
+		unsigned long long Peak = 0;
+		unsigned int Allocations = 0; //Live objects, deferred ones included
+	};
+
+	struct Budget
+	{
+		unsigned long long Bytes = 0; //0 = no budget
+		BudgetAction Action = BudgetAction::Warn;
+	};
+private:
+	struct Allocation
+	{
+		Category ObjectCategory;
+		unsigned long long Bytes;
+		std::string Label;
+		bool Released; //The owner has handed the name to the DeletionQueue
+	};
+
+	mutable std::mutex m_Mutex;
+	std::unordered_map<unsigned long long, Allocation> m_Allocations; //Keyed by object type and GL name
+	std::unordered_map<std::string, Usage> m_Labels;
+	Usage m_Categories[(int)Category::Count];
+	Usage m_Total;
+	unsigned long long m_Deferred;
+	Budget m_Budgets[(int)Category::Count];
+	Budget m_TotalBudget;
+
+	std::atomic<unsigned long long> m_FrameUploaded;
+	std::deque<float> m_UploadHistory; //Bytes per frame, oldest first
+	unsigned long long m_LastFrameUploaded;
+	unsigned long long m_PeakFrameUploaded;
+
+	GpuMemory();
+public:
+	~GpuMemory(); //Prints ReportLeaks
+
+	static GpuMemory& Get();
+	static const char* GetCategoryName(Category category);
+
+	//name is the buffer, texture or program name. Returns false and records nothing when a Refuse budget would be
+	//exceeded. refusable = false is for memory the renderer can't run without: it is recorded and only warns.
+	bool Allocate(Category category, unsigned int name, unsigned long long bytes, const std::string& label = "", bool refusable = true);
+	void SetLabel(Category category, unsigned int name, const std::string& label);
+
+	//Called by DeletionQueue: when the owner gives the name up, and when the object is really deleted
+	void OnRelease(DeletionQueue::Type type, unsigned int name);
+	void OnDelete(DeletionQueue::Type type, unsigned int name);
+
+	void OnUpload(unsigned long long bytes); //Any thread, GLStateCache::OnUpload forwards here
+	void EndFrame(); //Closes the frame's upload volume
+
+	void SetBudget(Category category, unsigned long long bytes, BudgetAction action = BudgetAction::Warn);
+	void SetTotalBudget(unsigned long long bytes, BudgetAction action = BudgetAction::Warn);
+
+	Usage GetUsage(Category category) const;
+	Usage GetTotalUsage() const;
+	unsigned long long GetDeferredBytes() const;
+	inline unsigned long long GetLastFrameUploaded() const { return m_LastFrameUploaded; }
+
+	//Prints every object whose owner never released it, grouped by label. Returns how many there are.
+	unsigned int ReportLeaks() const;
+
+	void OnImGuiRender();
+private:
+	static unsigned long long Key(DeletionQueue::Type type, unsigned int name);
+	static DeletionQueue::Type GetObjectType(Category category);
+	std::string GetLabelKey(Category category, const std::string& label) const;
+	bool IsOverBudget(const Budget& budget, unsigned long long current, unsigned long long bytes) const;
+	void Untrack(const Allocation& allocation); //Takes it out of every total, the caller erases it
+	void RemoveLabel(const Allocation& allocation);
+	void Add(Usage& usage, unsigned long long bytes);
+	void Remove(Usage& usage, unsigned long long bytes);
+};
@@ -1,25 +1,135 @@
 #include "IndexBuffer.h"
 #include "Renderer.h"
+#include "GLStateCache.h"
+#include "DeletionQueue.h"
+#include "GpuMemory.h"
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+//Copies the indices into the narrower type, returns data itself when it is already GL_UNSIGNED_INT
+template<typename T>
+static const void* Narrow(const unsigned int* data, unsigned int count, std::vector<unsigned char>& storage)
+{
+    storage.resize(count * sizeof(T));
+    T* narrowed = (T*)storage.data();
+    for (unsigned int i = 0; i < count; i++)
+        narrowed[i] = (T)data[i];
+    return storage.data();
+}
+
+static const void* ConvertIndices(const unsigned int* data, unsigned int count, unsigned int type, std::vector<unsigned char>& storage)
+{
+    switch (type)
+    {
+        case GL_UNSIGNED_BYTE:  return Narrow<GLubyte>(data, count, storage);
+        case GL_UNSIGNED_SHORT: return Narrow<GLushort>(data, count, storage);
+    }
+    return data;
+}
 
 IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
-    :m_Count(count)
+    :m_Count(count), m_Type(GetTypeFor(count ? *std::max_element(data, data + count) : 0)), m_Refused(false)
 {
+    std::vector<unsigned char> storage;
+    const void* indices = ConvertIndices(data, count, m_Type, storage);
+
     GLCall(glGenBuffers(1, &m_RendererID)); //One buffer and pointer to a unsigned int--> Generating a buffer and giving us an ID to refer later.
-    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID)); //Selecting(glbind**) the above buffer
-    GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(GLuint), data, GL_STATIC_DRAW)); //Put the data into the buffer
+    GLStateCache::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID); //Selecting(glbind**) the above buffer
+    if (!GpuMemory::Get().Allocate(GpuMemory::Category::IndexBuffer, m_RendererID, count * GetTypeSize()))
+    {
+        m_Count = 0; //Over budget: empty, draws with it draw nothing
+        m_Refused = true;
+    }
+    GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_Count * GetTypeSize(), m_Count ? indices : nullptr, GL_STATIC_DRAW)); //Put the data into the buffer
+    GLStateCache::Get().OnUpload(m_Count * GetTypeSize());
+}
+
+IndexBuffer::IndexBuffer(unsigned int count, unsigned int maxIndex)
+    :m_Count(count), m_Type(GetTypeFor(maxIndex)), m_Refused(false)
+{
+    GLCall(glGenBuffers(1, &m_RendererID));
+    GLStateCache::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
+    if (!GpuMemory::Get().Allocate(GpuMemory::Category::IndexBuffer, m_RendererID, count * GetTypeSize()))
+    {
+        m_Count = 0;
+        m_Refused = true;
+    }
+    GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_Count * GetTypeSize(), nullptr, GL_DYNAMIC_DRAW));
 }
 
 IndexBuffer::~IndexBuffer()
 {
-    GLCall(glDeleteBuffers(1, &m_RendererID));
+    DeletionQueue::Get().Enqueue(DeletionQueue::Type::Buffer, m_RendererID, m_Count * GetTypeSize());
+}
+
+IndexBuffer::IndexBuffer(IndexBuffer&& other) noexcept
+    :m_RendererID(other.m_RendererID), m_Count(other.m_Count), m_Type(other.m_Type), m_Refused(other.m_Refused)
+{
+    other.m_RendererID = 0;
+    other.m_Count = 0;
+}
+
+IndexBuffer& IndexBuffer::operator=(IndexBuffer&& other) noexcept
+{
+    //Swapped, other's destructor deletes the buffer this one held
+    std::swap(m_RendererID, other.m_RendererID);
+    std::swap(m_Count, other.m_Count);
+    std::swap(m_Type, other.m_Type);
+    std::swap(m_Refused, other.m_Refused);
+    return *this;
+}
+
+void IndexBuffer::SetLabel(const std::string& label)
+{
+    GpuMemory::Get().SetLabel(GpuMemory::Category::IndexBuffer, m_RendererID, label);
+}
+
+bool IndexBuffer::SetData(const unsigned int* data, unsigned int count, unsigned int firstIndex)
+{
+    ASSERT(count == 0 || GetTypeFor(*std::max_element(data, data + count)) <= m_Type); //The GL enums are in size order
+    if (m_Refused)
+        return false; //Reported by GpuMemory when it refused
+    ASSERT(firstIndex + count <= m_Count);
+    if (firstIndex + count > m_Count)
+        return false;
+    std::vector<unsigned char> storage;
+    const void* indices = ConvertIndices(data, count, m_Type, storage);
+
+    //Through the copy target: binding GL_ELEMENT_ARRAY_BUFFER would change whatever vertex array is bound
+    GLStateCache::Get().BindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID);
+    GLCall(glBufferSubData(GL_COPY_WRITE_BUFFER, firstIndex * GetTypeSize(), count * GetTypeSize(), indices));
+    GLStateCache::Get().OnUpload(count * GetTypeSize());
+    return true;
 }
 
 void IndexBuffer::Bind() const
 {
-    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID)); //Selecting(glbind**)
+    GLStateCache::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID); //Selecting(glbind**)
 }
 
 void IndexBuffer::Unbind() const
 {
-    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+    GLStateCache::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+unsigned int IndexBuffer::GetTypeFor(unsigned int maxIndex)
+{
+    if (maxIndex <= 0xff)
+        return GL_UNSIGNED_BYTE;
+    if (maxIndex <= 0xffff)
+        return GL_UNSIGNED_SHORT;
+    return GL_UNSIGNED_INT;
+}
+
+unsigned int IndexBuffer::GetSizeofType(unsigned int type)
+{
+    switch (type)
+    {
+        case GL_UNSIGNED_BYTE:  return 1;
+        case GL_UNSIGNED_SHORT: return 2;
+        case GL_UNSIGNED_INT:   return 4;
+    }
+    ASSERT(false);
+    return 0;
 }
@@ -1,15 +1,40 @@
 #pragma once
 
+#include <string>
+
 class IndexBuffer {
 private:
 	unsigned int m_RendererID;
 	unsigned int m_Count;
+	unsigned int m_Type; //GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+	bool m_Refused; //GpuMemory refused the storage, SetData has nowhere to write
 public:
+	//Stored as the narrowest type that holds the largest index: bytes up to 255, shorts up to 65535.
+	//Either constructor leaves the buffer empty (GetCount() 0) when GpuMemory refuses the size.
 	IndexBuffer(const unsigned int* data, unsigned int count);
+	//Dynamic buffer, filled later through SetData. maxIndex picks the type, no index set later may exceed it
+	IndexBuffer(unsigned int count, unsigned int maxIndex = 0xffffffff);
 	~IndexBuffer();
 
+	//Owns the GL buffer: move-only, a moved-from IndexBuffer is empty
+	IndexBuffer(const IndexBuffer&) = delete;
+	IndexBuffer& operator=(const IndexBuffer&) = delete;
+	IndexBuffer(IndexBuffer&& other) noexcept;
+	IndexBuffer& operator=(IndexBuffer&& other) noexcept;
+
+	//Narrowed to the buffer's type. False, with nothing written, when the storage was refused; a write past the end asserts
+	bool SetData(const unsigned int* data, unsigned int count, unsigned int firstIndex = 0);
+	void SetLabel(const std::string& label); //Name it is accounted under in GpuMemory
+
 	void Bind() const;
 	void Unbind() const;
 
 	inline unsigned int GetCount() const { return m_Count; }
+	inline unsigned int GetType() const { return m_Type; } //For the type argument of glDrawElements*
+	inline unsigned int GetTypeSize() const { return GetSizeofType(m_Type); }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline bool IsRefused() const { return m_Refused; }
+
+	static unsigned int GetTypeFor(unsigned int maxIndex);
+	static unsigned int GetSizeofType(unsigned int type);
 };
\ No newline at end of file
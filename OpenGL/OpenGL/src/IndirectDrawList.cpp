@@ -0,0 +1,110 @@
+#include "IndirectDrawList.h"
+#include "Renderer.h"
+#include "GLStateCache.h"
+#include "DeletionQueue.h"
+#include "GpuMemory.h"
+
+IndirectDrawList::IndirectDrawList(unsigned int maxDraws)
+    :m_MaxDraws(maxDraws), m_IndirectBufferID(0),
+    m_DrawIDBuffer(GenerateDrawIDs(maxDraws).data(), maxDraws * sizeof(float)),
+    m_MultiDraw(IsMultiDrawSupported()), m_Dirty(false)
+{
+    m_Commands.reserve(maxDraws);
+    if (IsMultiDrawSupported())
+    {
+        GLCall(glGenBuffers(1, &m_IndirectBufferID));
+        GpuMemory::Get().Allocate(GpuMemory::Category::Other, m_IndirectBufferID, maxDraws * sizeof(DrawElementsIndirectCommand), "IndirectDrawList commands", false);
+        GLStateCache::Get().BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_IndirectBufferID);
+        GLCall(glBufferData(GL_DRAW_INDIRECT_BUFFER, maxDraws * sizeof(DrawElementsIndirectCommand), nullptr, GL_DYNAMIC_DRAW));
+    }
+}
+
+IndirectDrawList::~IndirectDrawList()
+{
+    DeletionQueue::Get().Enqueue(DeletionQueue::Type::Buffer, m_IndirectBufferID, m_MaxDraws * sizeof(DrawElementsIndirectCommand));
+}
+
+bool IndirectDrawList::IsMultiDrawSupported()
+{
+    return GLEW_VERSION_4_3 || GLEW_ARB_multi_draw_indirect;
+}
+
+bool IndirectDrawList::IsBaseInstanceSupported()
+{
+    return GLEW_VERSION_4_2 || GLEW_ARB_base_instance;
+}
+
+int IndirectDrawList::Add(unsigned int indexCount, unsigned int firstIndex, int baseVertex)
+{
+    if (m_Commands.size() >= m_MaxDraws)
+        return -1;
+
+    unsigned int drawIndex = (unsigned int)m_Commands.size();
+    m_Commands.push_back({ indexCount, 1, firstIndex, baseVertex, drawIndex });
+    m_Dirty = true;
+    return (int)drawIndex;
+}
+
+void IndirectDrawList::Clear()
+{
+    m_Commands.clear();
+    m_Dirty = true;
+}
+
+void IndirectDrawList::SetMultiDrawEnabled(bool enabled)
+{
+    m_MultiDraw = enabled && IsMultiDrawSupported();
+}
+
+void IndirectDrawList::Draw(unsigned int indexType, unsigned int drawIDAttribute)
+{
+    if (m_Commands.empty())
+        return;
+
+    if (m_MultiDraw)
+    {
+        GLStateCache::Get().BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_IndirectBufferID);
+        if (m_Dirty)
+        {
+            GLCall(glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, m_Commands.size() * sizeof(DrawElementsIndirectCommand), m_Commands.data()));
+            GLStateCache::Get().OnUpload(m_Commands.size() * sizeof(DrawElementsIndirectCommand));
+            m_Dirty = false;
+        }
+        GLCall(glMultiDrawElementsIndirect(GL_TRIANGLES, indexType, nullptr, (GLsizei)m_Commands.size(), 0));
+        GLStateCache::Get().OnDraw();
+        return;
+    }
+
+    //Same command list, one call per draw
+    if (IsBaseInstanceSupported())
+    {
+        for (const DrawElementsIndirectCommand& command : m_Commands)
+        {
+            GLCall(glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, command.Count, indexType,
+                (const void*)((size_t)command.FirstIndex * IndexBuffer::GetSizeofType(indexType)), command.InstanceCount, command.BaseVertex, command.BaseInstance));
+        }
+        GLStateCache::Get().OnDraw((unsigned int)m_Commands.size());
+        return;
+    }
+
+    //GL 3.3 can't start an instanced attribute at baseInstance. Disabling the array makes the
+    //attribute read its current generic value instead, which can be set per draw.
+    GLCall(glDisableVertexAttribArray(drawIDAttribute));
+    for (const DrawElementsIndirectCommand& command : m_Commands)
+    {
+        GLCall(glVertexAttrib1f(drawIDAttribute, (float)command.BaseInstance));
+        GLCall(glDrawElementsInstancedBaseVertex(GL_TRIANGLES, command.Count, indexType,
+            (const void*)((size_t)command.FirstIndex * IndexBuffer::GetSizeofType(indexType)), command.InstanceCount, command.BaseVertex));
+    }
+    GLCall(glEnableVertexAttribArray(drawIDAttribute));
+    GLStateCache::Get().OnDraw((unsigned int)m_Commands.size());
+}
+
+std::vector<float> IndirectDrawList::GenerateDrawIDs(unsigned int count)
+{
+    //Floats are exact up to 2^24, plenty of draws
+    std::vector<float> ids(count);
+    for (unsigned int i = 0; i < count; i++)
+        ids[i] = (float)i;
+    return ids;
+}
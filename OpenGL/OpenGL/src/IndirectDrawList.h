@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+#include "VertexBuffer.h"
+
+//Draw commands for many meshes that live in one shared VertexArray/IndexBuffer and use the same shader.
+//With GL 4.3 (or ARB_multi_draw_indirect) the commands are uploaded to a GL_DRAW_INDIRECT_BUFFER and
+//drawn with a single glMultiDrawElementsIndirect, otherwise the same list is walked on the CPU.
+//
+//Every command draws one instance whose baseInstance is its index in the list. Add GetDrawIDBuffer()
+//to the VertexArray as a per-instance float attribute (Push<float>(1, 1)) and the shader receives the
+//draw index there, to fetch its per-draw data (e.g. from a texture buffer).
+class IndirectDrawList
+{
+public:
+	struct DrawElementsIndirectCommand //Layout fixed by GL
+	{
+		unsigned int Count;
+		unsigned int InstanceCount;
+		unsigned int FirstIndex;
+		int BaseVertex;
+		unsigned int BaseInstance;
+	};
+private:
+	std::vector<DrawElementsIndirectCommand> m_Commands;
+	unsigned int m_MaxDraws;
+	unsigned int m_IndirectBufferID;
+	VertexBuffer m_DrawIDBuffer;
+	bool m_MultiDraw;
+	bool m_Dirty;
+public:
+	IndirectDrawList(unsigned int maxDraws);
+	~IndirectDrawList();
+
+	//Returns the draw index, -1 when the list is full
+	int Add(unsigned int indexCount, unsigned int firstIndex, int baseVertex);
+	void Clear();
+
+	//Uploads the commands if they changed and draws them. indexType is the bound index buffer's GetType().
+	//drawIDAttribute is the location the draw ID buffer was added at, needed when the context can't offset instanced attributes.
+	void Draw(unsigned int indexType, unsigned int drawIDAttribute);
+
+	inline const VertexBuffer& GetDrawIDBuffer() const { return m_DrawIDBuffer; }
+	inline unsigned int GetCount() const { return (unsigned int)m_Commands.size(); }
+
+	inline bool IsMultiDrawEnabled() const { return m_MultiDraw; }
+	void SetMultiDrawEnabled(bool enabled); //Ignored when the context has no multi-draw indirect
+
+	static bool IsMultiDrawSupported();
+	static bool IsBaseInstanceSupported();
+private:
+	static std::vector<float> GenerateDrawIDs(unsigned int count);
+};
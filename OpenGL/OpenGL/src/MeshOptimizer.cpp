@@ -0,0 +1,242 @@
+#include "MeshOptimizer.h"
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+MeshOptimizer::CacheStats MeshOptimizer::AnalyzeVertexCache(const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount,
+    unsigned int cacheSize)
+{
+    CacheStats stats;
+    //Insertion time per vertex: a vertex is still cached while fewer than cacheSize others were inserted after it
+    std::vector<unsigned int> insertedAt(vertexCount, 0);
+    std::vector<bool> used(vertexCount, false);
+    unsigned int time = cacheSize + 1;
+    unsigned int usedCount = 0;
+    for (unsigned int i = 0; i < indexCount; i++)
+    {
+        unsigned int vertex = indices[i];
+        if (time - insertedAt[vertex] > cacheSize)
+        {
+            insertedAt[vertex] = time++;
+            stats.VerticesTransformed++;
+        }
+        if (!used[vertex])
+        {
+            used[vertex] = true;
+            usedCount++;
+        }
+    }
+
+    if (indexCount >= 3)
+        stats.ACMR = (float)stats.VerticesTransformed / (indexCount / 3);
+    if (usedCount > 0)
+        stats.ATVR = (float)stats.VerticesTransformed / usedCount;
+    return stats;
+}
+
+void MeshOptimizer::OptimizeVertexCache(unsigned int* destination, const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount,
+    unsigned int cacheSize)
+{
+    unsigned int triangleCount = indexCount / 3;
+    if (triangleCount == 0 || vertexCount == 0)
+        return;
+    std::vector<unsigned int> input(indices, indices + triangleCount * 3); //destination may be indices
+
+    //Triangles around each vertex, packed: those of vertex v are at [offsets[v], offsets[v + 1])
+    std::vector<unsigned int> liveTriangles(vertexCount, 0);
+    for (unsigned int index : input)
+        liveTriangles[index]++;
+    std::vector<unsigned int> offsets(vertexCount + 1, 0);
+    for (unsigned int v = 0; v < vertexCount; v++)
+        offsets[v + 1] = offsets[v] + liveTriangles[v];
+    std::vector<unsigned int> adjacency(input.size());
+    std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+    for (unsigned int t = 0; t < triangleCount; t++)
+    {
+        for (unsigned int corner = 0; corner < 3; corner++)
+            adjacency[fill[input[t * 3 + corner]]++] = t;
+    }
+
+    std::vector<unsigned int> cacheTime(vertexCount, 0);
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<unsigned int> deadEnds; //Recently used vertices, to restart from when a fan runs dry
+    std::vector<unsigned int> candidates;
+    unsigned int time = cacheSize + 1;
+    unsigned int cursor = 0; //Next vertex to try once the dead-end stack is empty
+    unsigned int written = 0;
+
+    int fanning = 0;
+    while (fanning >= 0)
+    {
+        candidates.clear();
+        //Emit every triangle still around the fanning vertex
+        for (unsigned int a = offsets[fanning]; a < offsets[fanning + 1]; a++)
+        {
+            unsigned int triangle = adjacency[a];
+            if (emitted[triangle])
+                continue;
+            for (unsigned int corner = 0; corner < 3; corner++)
+            {
+                unsigned int vertex = input[triangle * 3 + corner];
+                destination[written++] = vertex;
+                deadEnds.push_back(vertex);
+                candidates.push_back(vertex);
+                liveTriangles[vertex]--;
+                if (time - cacheTime[vertex] > cacheSize)
+                    cacheTime[vertex] = time++;
+            }
+            emitted[triangle] = true;
+        }
+
+        //Next fan: the candidate that will still be in the cache after its remaining triangles are emitted,
+        //oldest first since it is the one about to fall out
+        fanning = -1;
+        int bestPriority = -1;
+        for (unsigned int vertex : candidates)
+        {
+            if (liveTriangles[vertex] == 0)
+                continue;
+            int priority = 0;
+            if (time - cacheTime[vertex] + 2 * liveTriangles[vertex] <= cacheSize)
+                priority = time - cacheTime[vertex];
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                fanning = vertex;
+            }
+        }
+        if (fanning >= 0)
+            continue;
+
+        //Dead end: go back to a recent vertex with triangles left, or else the next one in input order
+        while (!deadEnds.empty() && fanning < 0)
+        {
+            unsigned int vertex = deadEnds.back();
+            deadEnds.pop_back();
+            if (liveTriangles[vertex] > 0)
+                fanning = vertex;
+        }
+        while (fanning < 0 && cursor < vertexCount)
+        {
+            if (liveTriangles[cursor] > 0)
+                fanning = cursor;
+            cursor++;
+        }
+    }
+}
+
+void MeshOptimizer::OptimizeOverdraw(unsigned int* destination, const unsigned int* indices, unsigned int indexCount,
+    const float* positions, unsigned int vertexCount, unsigned int positionStride, float threshold, unsigned int cacheSize)
+{
+    unsigned int triangleCount = indexCount / 3;
+    if (triangleCount == 0 || vertexCount == 0)
+        return;
+    std::vector<unsigned int> input(indices, indices + triangleCount * 3);
+    auto position = [&](unsigned int vertex) { return (const float*)((const char*)positions + (size_t)vertex * positionStride); };
+
+    //Clusters start at triangles whose three vertices all miss the cache: the order is cold there anyway,
+    //so moving a cluster costs almost nothing in vertex reuse
+    std::vector<unsigned int> clusterStarts;
+    std::vector<unsigned int> insertedAt(vertexCount, 0);
+    unsigned int time = cacheSize + 1;
+    for (unsigned int t = 0; t < triangleCount; t++)
+    {
+        unsigned int misses = 0;
+        for (unsigned int corner = 0; corner < 3; corner++)
+        {
+            unsigned int vertex = input[t * 3 + corner];
+            if (time - insertedAt[vertex] > cacheSize)
+            {
+                insertedAt[vertex] = time++;
+                misses++;
+            }
+        }
+        if (misses == 3 || t == 0)
+            clusterStarts.push_back(t);
+    }
+    clusterStarts.push_back(triangleCount);
+    unsigned int clusterCount = (unsigned int)clusterStarts.size() - 1;
+    if (clusterCount < 2)
+    {
+        std::copy(input.begin(), input.end(), destination);
+        return;
+    }
+
+    //Area weighted centroid and normal of the mesh and of each cluster
+    std::vector<float> clusterCentroids(clusterCount * 3, 0.0f), clusterNormals(clusterCount * 3, 0.0f);
+    float meshCentroid[3] = { 0.0f, 0.0f, 0.0f };
+    float meshArea = 0.0f;
+    for (unsigned int cluster = 0; cluster < clusterCount; cluster++)
+    {
+        float clusterArea = 0.0f;
+        for (unsigned int t = clusterStarts[cluster]; t < clusterStarts[cluster + 1]; t++)
+        {
+            const float* p0 = position(input[t * 3]);
+            const float* p1 = position(input[t * 3 + 1]);
+            const float* p2 = position(input[t * 3 + 2]);
+            float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+            float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+            float normal[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+            float area = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            for (int axis = 0; axis < 3; axis++)
+            {
+                float center = (p0[axis] + p1[axis] + p2[axis]) / 3.0f;
+                clusterCentroids[cluster * 3 + axis] += center * area;
+                clusterNormals[cluster * 3 + axis] += normal[axis]; //Length of the cross product is already the weight
+                meshCentroid[axis] += center * area;
+            }
+            clusterArea += area;
+        }
+        for (int axis = 0; axis < 3 && clusterArea > 0.0f; axis++)
+            clusterCentroids[cluster * 3 + axis] /= clusterArea;
+        meshArea += clusterArea;
+    }
+    for (int axis = 0; axis < 3 && meshArea > 0.0f; axis++)
+        meshCentroid[axis] /= meshArea;
+
+    //Clusters that face away from the middle of the mesh are the outer surface, seen from most directions first
+    std::vector<float> sortKeys(clusterCount);
+    for (unsigned int cluster = 0; cluster < clusterCount; cluster++)
+    {
+        const float* normal = &clusterNormals[cluster * 3];
+        float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        float key = 0.0f;
+        for (int axis = 0; axis < 3 && length > 0.0f; axis++)
+            key += (clusterCentroids[cluster * 3 + axis] - meshCentroid[axis]) * normal[axis] / length;
+        sortKeys[cluster] = key;
+    }
+    std::vector<unsigned int> order(clusterCount);
+    for (unsigned int cluster = 0; cluster < clusterCount; cluster++)
+        order[cluster] = cluster;
+    std::stable_sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b) { return sortKeys[a] > sortKeys[b]; });
+
+    std::vector<unsigned int> sorted;
+    sorted.reserve(input.size());
+    for (unsigned int cluster : order)
+        sorted.insert(sorted.end(), input.begin() + clusterStarts[cluster] * 3, input.begin() + clusterStarts[cluster + 1] * 3);
+
+    float before = AnalyzeVertexCache(input.data(), (unsigned int)input.size(), vertexCount, cacheSize).ACMR;
+    float after = AnalyzeVertexCache(sorted.data(), (unsigned int)sorted.size(), vertexCount, cacheSize).ACMR;
+    const std::vector<unsigned int>& result = after <= before * threshold ? sorted : input;
+    std::copy(result.begin(), result.end(), destination);
+}
+
+unsigned int MeshOptimizer::OptimizeVertexFetch(void* destinationVertices, unsigned int* indices, unsigned int indexCount,
+    const void* vertices, unsigned int vertexCount, unsigned int vertexSize)
+{
+    const unsigned int Unused = 0xffffffff;
+    std::vector<unsigned int> remap(vertexCount, Unused);
+    unsigned int next = 0;
+    for (unsigned int i = 0; i < indexCount; i++)
+    {
+        unsigned int& newIndex = remap[indices[i]];
+        if (newIndex == Unused)
+        {
+            newIndex = next++;
+            memcpy((char*)destinationVertices + (size_t)newIndex * vertexSize, (const char*)vertices + (size_t)indices[i] * vertexSize, vertexSize);
+        }
+        indices[i] = newIndex;
+    }
+    return next;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+//CPU-side passes over triangle lists, run before the data goes into a VertexBuffer/IndexBuffer.
+//Usual order: OptimizeVertexCache, then OptimizeOverdraw, then OptimizeVertexFetch (which renumbers the vertices).
+//None of them change what is drawn, only the order of triangles and vertices. Everything is GL free, so
+//the same calls work at load time and in an offline tool.
+class MeshOptimizer
+{
+public:
+	static const unsigned int DefaultCacheSize = 16; //Post-transform cache entries, close to what current GPUs behave like
+
+	struct CacheStats
+	{
+		unsigned int VerticesTransformed = 0; //Cache misses
+		float ACMR = 0.0f; //Average cache miss ratio: transformed vertices per triangle, 0.5 at best, 3 at worst
+		float ATVR = 0.0f; //Average transform to vertex ratio: 1 means every vertex is shaded exactly once
+	};
+
+	//Simulates a FIFO post-transform cache over the index list
+	static CacheStats AnalyzeVertexCache(const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount,
+		unsigned int cacheSize = DefaultCacheSize);
+
+	//Tipsify (Sander, Nehab, Barczak 2007): fans around recently used vertices, linear time.
+	//destination gets the reordered indices and may be indices itself.
+	static void OptimizeVertexCache(unsigned int* destination, const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount,
+		unsigned int cacheSize = DefaultCacheSize);
+
+	//Splits the cache-ordered list where the cache was cold anyway and sorts those clusters outside-in, so front
+	//surfaces tend to be drawn first and hide more of what comes after. The result is kept only while its ACMR
+	//stays within threshold times the input's. positions: 3 floats per vertex, positionStride bytes apart.
+	static void OptimizeOverdraw(unsigned int* destination, const unsigned int* indices, unsigned int indexCount,
+		const float* positions, unsigned int vertexCount, unsigned int positionStride, float threshold = 1.05f,
+		unsigned int cacheSize = DefaultCacheSize);
+
+	//Reorders vertices by first use so the vertex fetch walks memory linearly, drops unreferenced vertices and
+	//rewrites indices to match. destinationVertices must not overlap vertices. Returns the new vertex count.
+	static unsigned int OptimizeVertexFetch(void* destinationVertices, unsigned int* indices, unsigned int indexCount,
+		const void* vertices, unsigned int vertexCount, unsigned int vertexSize);
+};
@@ -0,0 +1,440 @@
+#include "Profiler.h"
+#include "Renderer.h"
+#include "imgui/imgui.h"
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+
+static std::atomic<unsigned int> s_NextThread(0);
+static thread_local unsigned int s_Thread = s_NextThread++;
+static thread_local unsigned int s_Depth = 0;
+
+Profiler::Profiler()
+    :m_Epoch(std::chrono::high_resolution_clock::now()), m_FrameIndex(0), m_FrameOpen(false),
+    m_Enabled(true), m_GpuEnabled(true), m_GpuFrame(false), m_GpuClockSynced(false), m_GpuEpochNs(0),
+    m_CaptureRemaining(0)
+{
+}
+
+Profiler& Profiler::Get()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+void Profiler::ReleaseQueries()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for (FrameSlot& slot : m_Slots)
+    {
+        if (!slot.Queries.empty())
+        {
+            GLCall(glDeleteQueries((GLsizei)slot.Queries.size(), slot.Queries.data()));
+        }
+        slot.Queries.clear();
+        slot.QueriesUsed = 0;
+        slot.FrameQuery = -1;
+        std::fill(slot.EventQueries.begin(), slot.EventQueries.end(), -1);
+    }
+    m_GpuClockSynced = false;
+}
+
+void Profiler::SetEnabled(bool enabled)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Enabled = enabled;
+}
+
+void Profiler::SetGpuEnabled(bool enabled)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_GpuEnabled = enabled;
+}
+
+double Profiler::NowMs() const
+{
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - m_Epoch;
+    return elapsed.count();
+}
+
+unsigned int Profiler::NextQuery(FrameSlot& slot)
+{
+    if (slot.QueriesUsed == slot.Queries.size())
+    {
+        //Grow the pool, it settles after the first few frames
+        unsigned int grow = std::max(64u, (unsigned int)slot.Queries.size());
+        slot.Queries.resize(slot.Queries.size() + grow);
+        GLCall(glGenQueries(grow, &slot.Queries[slot.QueriesUsed]));
+    }
+    return slot.QueriesUsed++;
+}
+
+void Profiler::BeginFrame()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    FrameSlot& slot = m_Slots[m_FrameIndex % FrameLatency];
+    if (slot.InFlight)
+        ResolveSlot(slot);
+
+    if (!m_Enabled)
+        return;
+
+    m_GLThread = std::this_thread::get_id();
+    m_GpuFrame = m_GpuEnabled;
+    if (m_GpuFrame && !m_GpuClockSynced)
+    {
+        //The only synchronous query, lines GPU timestamps up with the CPU clock
+        GLint64 gpuNow;
+        GLCall(glGetInteger64v(GL_TIMESTAMP, &gpuNow));
+        m_GpuEpochNs = gpuNow - (long long)(NowMs() * 1000000.0);
+        m_GpuClockSynced = true;
+    }
+
+    slot.Data.Index = m_FrameIndex;
+    slot.Data.StartMs = NowMs();
+    if (m_GpuFrame)
+    {
+        slot.FrameQuery = NextQuery(slot);
+        NextQuery(slot);
+        GLCall(glQueryCounter(slot.Queries[slot.FrameQuery], GL_TIMESTAMP));
+    }
+    m_FrameOpen = true;
+}
+
+void Profiler::EndFrame()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (!m_FrameOpen)
+        return;
+
+    FrameSlot& slot = m_Slots[m_FrameIndex % FrameLatency];
+    slot.Data.CpuMs = NowMs() - slot.Data.StartMs;
+    if (slot.FrameQuery >= 0)
+    {
+        GLCall(glQueryCounter(slot.Queries[slot.FrameQuery + 1], GL_TIMESTAMP));
+    }
+
+    slot.InFlight = true;
+    m_FrameOpen = false;
+    m_FrameIndex++;
+}
+
+int Profiler::BeginScope(const char* name, bool gpu)
+{
+    if (!m_FrameOpen)
+        return -1;
+
+    double start = NowMs();
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (!m_FrameOpen)
+        return -1;
+
+    FrameSlot& slot = m_Slots[m_FrameIndex % FrameLatency];
+    if (slot.Data.Events.size() >= MaxEventsPerFrame)
+    {
+        slot.Data.DroppedEvents++;
+        return -1;
+    }
+
+    int query = -1;
+    if (gpu && m_GpuFrame && std::this_thread::get_id() == m_GLThread)
+    {
+        query = NextQuery(slot);
+        NextQuery(slot);
+        GLCall(glQueryCounter(slot.Queries[query], GL_TIMESTAMP));
+    }
+
+    slot.Data.Events.push_back({ name, s_Thread, s_Depth++, start, 0.0, -1.0, -1.0 });
+    slot.EventQueries.push_back(query);
+    return (int)slot.Data.Events.size() - 1;
+}
+
+void Profiler::EndScope(int event)
+{
+    s_Depth--;
+    double end = NowMs();
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    FrameSlot& slot = m_Slots[m_FrameIndex % FrameLatency];
+    if (!m_FrameOpen || event >= (int)slot.Data.Events.size())
+        return;
+
+    Event& e = slot.Data.Events[event];
+    e.DurationMs = end - e.StartMs;
+    if (slot.EventQueries[event] >= 0)
+    {
+        GLCall(glQueryCounter(slot.Queries[slot.EventQueries[event] + 1], GL_TIMESTAMP));
+    }
+}
+
+void Profiler::ResolveSlot(FrameSlot& slot)
+{
+    Frame& frame = slot.Data;
+    frame.GpuMs = -1.0;
+    if (slot.QueriesUsed > 0)
+    {
+        //Timestamps complete in submission order. The frame's end is issued after everything else, so it being ready
+        //means they all are; without it each scope's end has to be checked, outer scopes end after the inner ones
+        auto isAvailable = [&](int query)
+        {
+            GLint available = 0;
+            GLCall(glGetQueryObjectiv(slot.Queries[query], GL_QUERY_RESULT_AVAILABLE, &available));
+            return available != 0;
+        };
+        bool available = true;
+        if (slot.FrameQuery >= 0)
+            available = isAvailable(slot.FrameQuery + 1);
+        else
+        {
+            for (unsigned int i = 0; i < frame.Events.size() && available; i++)
+            {
+                if (slot.EventQueries[i] >= 0)
+                    available = isAvailable(slot.EventQueries[i] + 1);
+            }
+        }
+        if (available)
+        {
+            auto timestamp = [&](int query)
+            {
+                GLuint64 ns;
+                GLCall(glGetQueryObjectui64v(slot.Queries[query], GL_QUERY_RESULT, &ns));
+                return (double)((long long)ns - m_GpuEpochNs) / 1000000.0;
+            };
+
+            if (slot.FrameQuery >= 0)
+                frame.GpuMs = timestamp(slot.FrameQuery + 1) - timestamp(slot.FrameQuery);
+            for (unsigned int i = 0; i < frame.Events.size(); i++)
+            {
+                if (slot.EventQueries[i] < 0)
+                    continue;
+                Event& e = frame.Events[i];
+                e.GpuStartMs = timestamp(slot.EventQueries[i]);
+                e.GpuDurationMs = timestamp(slot.EventQueries[i] + 1) - e.GpuStartMs;
+            }
+        }
+    }
+
+    m_History.push_back(frame);
+    if (m_History.size() > HistorySize)
+        m_History.pop_front();
+    if (m_CaptureRemaining > 0)
+    {
+        m_Capture.push_back(frame);
+        m_CaptureRemaining--;
+    }
+
+    //Keep the capacity, the next frame will need about as much
+    frame.Events.clear();
+    frame.DroppedEvents = 0;
+    slot.EventQueries.clear();
+    slot.QueriesUsed = 0;
+    slot.FrameQuery = -1;
+    slot.InFlight = false;
+}
+
+bool Profiler::GetLastFrame(Frame& frame) const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (m_History.empty())
+        return false;
+    frame = m_History.back();
+    return true;
+}
+
+void Profiler::GetHistory(std::vector<Frame>& frames) const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    frames.assign(m_History.begin(), m_History.end());
+}
+
+void Profiler::StartCapture(unsigned int frameCount)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Capture.clear();
+    m_CaptureRemaining = frameCount;
+}
+
+bool Profiler::IsCapturing() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_CaptureRemaining > 0;
+}
+
+static void WriteJsonString(std::ostream& stream, const char* text)
+{
+    stream << '"';
+    for (const char* c = text; *c; c++)
+    {
+        if (*c == '"' || *c == '\\')
+            stream << '\\';
+        stream << *c;
+    }
+    stream << '"';
+}
+
+void Profiler::WriteTrace(std::ostream& stream, const std::vector<Frame>& frames) const
+{
+    //Chrome trace timestamps are in microseconds
+    const unsigned int framesTrack = 1000, gpuTrack = 1001;
+    unsigned int threadCount = 0;
+    for (const Frame& frame : frames)
+        for (const Event& e : frame.Events)
+            threadCount = std::max(threadCount, e.Thread + 1);
+
+    stream << "{\"traceEvents\":[\n";
+    stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << framesTrack << ",\"args\":{\"name\":\"Frames\"}},\n";
+    stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << gpuTrack << ",\"args\":{\"name\":\"GPU\"}}";
+    for (unsigned int t = 0; t < threadCount; t++)
+        stream << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t << ",\"args\":{\"name\":\"CPU thread " << t << "\"}}";
+
+    for (const Frame& frame : frames)
+    {
+        stream << ",\n{\"name\":\"Frame " << frame.Index << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << framesTrack
+            << ",\"ts\":" << frame.StartMs * 1000.0 << ",\"dur\":" << frame.CpuMs * 1000.0
+            << ",\"args\":{\"gpu_ms\":" << frame.GpuMs << ",\"dropped_events\":" << frame.DroppedEvents << "}}";
+        for (const Event& e : frame.Events)
+        {
+            stream << ",\n{\"name\":";
+            WriteJsonString(stream, e.Name);
+            stream << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.Thread << ",\"ts\":" << e.StartMs * 1000.0 << ",\"dur\":" << e.DurationMs * 1000.0 << "}";
+            if (e.GpuStartMs < 0.0)
+                continue;
+            stream << ",\n{\"name\":";
+            WriteJsonString(stream, e.Name);
+            stream << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << gpuTrack << ",\"ts\":" << e.GpuStartMs * 1000.0 << ",\"dur\":" << e.GpuDurationMs * 1000.0 << "}";
+        }
+    }
+    stream << "\n]}\n";
+}
+
+bool Profiler::WriteChromeTrace(const std::string& filepath) const
+{
+    std::vector<Frame> frames;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        frames = m_Capture;
+    }
+
+    std::ofstream stream(filepath);
+    if (!stream)
+    {
+        std::cout << "[Profiler] Could not open " << filepath << std::endl;
+        return false;
+    }
+    WriteTrace(stream, frames);
+    return true;
+}
+
+//Scopes with the same name under the same parent are merged, 500 draws show up as one line
+struct ProfileNode
+{
+    const char* Name;
+    unsigned int Thread;
+    unsigned int Count;
+    double CpuMs;
+    double GpuMs;
+    std::vector<unsigned int> Children;
+};
+
+static void DrawProfileNode(const std::vector<ProfileNode>& nodes, unsigned int index, unsigned int depth)
+{
+    const ProfileNode& node = nodes[index];
+    if (node.GpuMs >= 0.0)
+        ImGui::Text("%*s%s x%u  cpu %.3f ms  gpu %.3f ms", depth * 2, "", node.Name, node.Count, node.CpuMs, node.GpuMs);
+    else
+        ImGui::Text("%*s%s x%u  cpu %.3f ms", depth * 2, "", node.Name, node.Count, node.CpuMs);
+    for (unsigned int child : node.Children)
+        DrawProfileNode(nodes, child, depth + 1);
+}
+
+void Profiler::OnImGuiRender()
+{
+    ImGui::Begin("Profiler");
+
+    bool enabled = m_Enabled, gpuEnabled = m_GpuEnabled;
+    if (ImGui::Checkbox("Enabled", &enabled))
+        SetEnabled(enabled);
+    ImGui::SameLine();
+    if (ImGui::Checkbox("GPU", &gpuEnabled))
+        SetGpuEnabled(gpuEnabled);
+
+    if (IsCapturing())
+        ImGui::Text("Capturing...");
+    else
+    {
+        if (ImGui::Button("Capture 60 frames"))
+            StartCapture(60);
+        ImGui::SameLine();
+        if (ImGui::Button("Save profile.json"))
+            WriteChromeTrace("profile.json");
+    }
+
+    std::vector<Frame> history;
+    GetHistory(history);
+    if (history.empty())
+    {
+        ImGui::End();
+        return;
+    }
+
+    double cpuTotal = 0.0, gpuTotal = 0.0;
+    unsigned int gpuFrames = 0;
+    for (const Frame& frame : history)
+    {
+        cpuTotal += frame.CpuMs;
+        if (frame.GpuMs >= 0.0)
+        {
+            gpuTotal += frame.GpuMs;
+            gpuFrames++;
+        }
+    }
+    ImGui::Text("Average over %u frames: cpu %.3f ms, gpu %.3f ms", (unsigned int)history.size(),
+        cpuTotal / history.size(), gpuFrames ? gpuTotal / gpuFrames : 0.0);
+
+    const Frame& frame = history.back();
+    ImGui::Text("Frame %u: cpu %.3f ms, gpu %.3f ms, %u scopes dropped", frame.Index, frame.CpuMs, frame.GpuMs, frame.DroppedEvents);
+
+    //Events of one thread are in start order, so a stack per thread recovers the tree
+    std::vector<ProfileNode> nodes;
+    std::vector<unsigned int> roots;
+    std::vector<std::vector<unsigned int>> stacks;
+    for (const Event& e : frame.Events)
+    {
+        if (e.Thread >= stacks.size())
+            stacks.resize(e.Thread + 1);
+        std::vector<unsigned int>& stack = stacks[e.Thread];
+        if (stack.size() > e.Depth)
+            stack.resize(e.Depth);
+
+        int parent = stack.empty() ? -1 : (int)stack.back();
+        std::vector<unsigned int>& siblings = parent < 0 ? roots : nodes[parent].Children;
+        unsigned int index = (unsigned int)nodes.size();
+        for (unsigned int sibling : siblings)
+        {
+            if (nodes[sibling].Thread == e.Thread && strcmp(nodes[sibling].Name, e.Name) == 0)
+            {
+                index = sibling;
+                break;
+            }
+        }
+        if (index == nodes.size())
+        {
+            siblings.push_back(index); //Before push_back below, which can move the parent's vector
+            nodes.push_back({ e.Name, e.Thread, 0, 0.0, -1.0, {} });
+        }
+
+        ProfileNode& node = nodes[index];
+        node.Count++;
+        node.CpuMs += e.DurationMs;
+        if (e.GpuDurationMs >= 0.0)
+            node.GpuMs = (node.GpuMs < 0.0 ? 0.0 : node.GpuMs) + e.GpuDurationMs;
+        stack.push_back(index);
+    }
+
+    for (unsigned int root : roots)
+    {
+        ImGui::Text("[thread %u]", nodes[root].Thread);
+        DrawProfileNode(nodes, root, 1);
+    }
+    ImGui::End();
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <string>
+#include <iosfwd>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <chrono>
+#include <thread>
+#include <atomic>
+
+//Hierarchical frame profiler. PROFILE_SCOPE measures CPU time of the enclosing block, PROFILE_GPU_SCOPE
+//measures it on the GPU as well with a pair of GL_TIMESTAMP queries (GL_TIME_ELAPSED queries can't nest).
+//Query results are read FrameLatency frames later, and only if they are available by then,
+//so profiling never waits for the GPU.
+//
+//CPU scopes work on any thread but must not span BeginFrame/EndFrame. GPU scopes only issue queries
+//on the thread that calls BeginFrame/EndFrame, which has to own the context.
+class Profiler
+{
+public:
+	static const unsigned int FrameLatency = 4; //Frames in flight before GPU results are read back
+	static const unsigned int HistorySize = 120; //Resolved frames kept for the panel
+	static const unsigned int MaxEventsPerFrame = 8192; //Further scopes in a frame are dropped and counted
+
+	struct Event
+	{
+		const char* Name; //Must outlive the profiler, the macros pass string literals
+		unsigned int Thread; //Small index, in the order threads first used the profiler
+		unsigned int Depth;
+		double StartMs; //Since the profiler was created
+		double DurationMs;
+		double GpuStartMs; //On the same timeline as StartMs, negative when not measured
+		double GpuDurationMs;
+	};
+
+	struct Frame
+	{
+		unsigned int Index = 0;
+		double StartMs = 0.0;
+		double CpuMs = 0.0;
+		double GpuMs = -1.0; //Negative when the results were not ready in time
+		unsigned int DroppedEvents = 0;
+		std::vector<Event> Events;
+	};
+private:
+	struct FrameSlot
+	{
+		Frame Data;
+		std::vector<unsigned int> Queries; //Pool, two per GPU scope plus two for the frame
+		unsigned int QueriesUsed = 0;
+		std::vector<int> EventQueries; //Per event: index of its begin query, or -1
+		int FrameQuery = -1;
+		bool InFlight = false;
+	};
+
+	mutable std::mutex m_Mutex;
+	std::chrono::high_resolution_clock::time_point m_Epoch;
+	FrameSlot m_Slots[FrameLatency];
+	unsigned int m_FrameIndex;
+	std::atomic<bool> m_FrameOpen; //Scopes outside a frame return early without taking the lock
+	bool m_Enabled;
+	bool m_GpuEnabled;
+	bool m_GpuFrame; //GPU profiling of the open frame
+	std::thread::id m_GLThread;
+	bool m_GpuClockSynced;
+	long long m_GpuEpochNs; //GPU timestamp matching m_Epoch
+
+	std::deque<Frame> m_History;
+	std::vector<Frame> m_Capture;
+	unsigned int m_CaptureRemaining;
+public:
+	Profiler();
+
+	static Profiler& Get();
+
+	//Deletes the query objects. Call before the context goes away, with it current
+	void ReleaseQueries();
+
+	void SetEnabled(bool enabled); //Both take effect at the next BeginFrame
+	void SetGpuEnabled(bool enabled);
+	inline bool IsEnabled() const { return m_Enabled; }
+	inline bool IsGpuEnabled() const { return m_GpuEnabled; }
+
+	void BeginFrame(); //Also reads back the GPU results of the frame FrameLatency frames ago
+	void EndFrame();
+
+	//Used by the macros. Returns the event index for EndScope, or -1 when nothing is recorded
+	int BeginScope(const char* name, bool gpu);
+	void EndScope(int event);
+
+	//Latest frame whose GPU results came back (or were given up on)
+	bool GetLastFrame(Frame& frame) const;
+	void GetHistory(std::vector<Frame>& frames) const;
+
+	//Collect the next frameCount resolved frames for WriteChromeTrace
+	void StartCapture(unsigned int frameCount);
+	bool IsCapturing() const;
+	//chrome://tracing / Perfetto JSON of the captured frames, GPU scopes on a track of their own
+	bool WriteChromeTrace(const std::string& filepath) const;
+
+	void OnImGuiRender();
+private:
+	double NowMs() const;
+	unsigned int NextQuery(FrameSlot& slot);
+	void ResolveSlot(FrameSlot& slot);
+	void WriteTrace(std::ostream& stream, const std::vector<Frame>& frames) const;
+};
+
+class ProfileScope
+{
+private:
+	int m_Event;
+public:
+	ProfileScope(const char* name, bool gpu = false)
+		:m_Event(Profiler::Get().BeginScope(name, gpu)) {}
+	~ProfileScope() { if (m_Event >= 0) Profiler::Get().EndScope(m_Event); }
+};
+
+#ifndef DISABLE_PROFILING
+	#define PROFILE_CONCAT_INNER(a, b) a##b
+	#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+	#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+	#define PROFILE_GPU_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name, true)
+#else
+	#define PROFILE_SCOPE(name)
+	#define PROFILE_GPU_SCOPE(name)
+#endif
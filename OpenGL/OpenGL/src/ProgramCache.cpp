@@ -0,0 +1,219 @@
+#include "ProgramCache.h"
+#include "GLDebug.h"
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <cerrno>
+
+#ifdef _MSC_VER
+    #include <direct.h>
+#else
+    #include <sys/stat.h>
+#endif
+
+//Start of every cache file, the binary follows
+struct ProgramBinaryHeader
+{
+    char Magic[4];
+    unsigned int Version;
+    unsigned long long Key; //Also in the file name, checked in case a file was copied or renamed
+    unsigned int Format;
+    unsigned int Length;
+};
+
+static const char s_Magic[4] = { 'G', 'L', 'P', 'B' };
+static const unsigned int s_Version = 1;
+
+//FNV-1a, 64 bit
+static void Hash(unsigned long long& hash, const void* data, size_t size)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+}
+
+ProgramCache::ProgramCache()
+    :m_Directory("resources/shadercache"), m_Enabled(true), m_Queried(false), m_Supported(false)
+{
+}
+
+ProgramCache& ProgramCache::Get()
+{
+    static ProgramCache cache;
+    return cache;
+}
+
+void ProgramCache::SetDirectory(const std::string& directory)
+{
+    m_Directory = directory;
+}
+
+void ProgramCache::SetEnabled(bool enabled)
+{
+    m_Enabled = enabled;
+}
+
+bool ProgramCache::IsSupported()
+{
+    Query();
+    return m_Supported;
+}
+
+unsigned long long ProgramCache::GetKey(const std::vector<std::string>& sources)
+{
+    Query();
+    unsigned long long hash = 14695981039346656037ull;
+    for (const std::string& source : sources)
+    {
+        unsigned long long size = source.size(); //Keeps "ab" + "c" apart from "a" + "bc"
+        Hash(hash, &size, sizeof(size));
+        Hash(hash, source.data(), source.size());
+    }
+    Hash(hash, m_Driver.data(), m_Driver.size());
+    return hash;
+}
+
+unsigned int ProgramCache::Load(unsigned long long key)
+{
+    if (!m_Enabled || !IsSupported())
+        return 0;
+
+    std::string path = GetPath(key);
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream)
+    {
+        m_Stats.Misses++;
+        return 0;
+    }
+
+    ProgramBinaryHeader header;
+    std::vector<char> binary;
+    bool valid = (bool)stream.read((char*)&header, sizeof(header)) && memcmp(header.Magic, s_Magic, sizeof(s_Magic)) == 0
+        && header.Version == s_Version && header.Key == key && header.Length != 0
+        && std::find(m_Formats.begin(), m_Formats.end(), (int)header.Format) != m_Formats.end(); //An unknown format is a GL error, not a failed link
+    if (valid)
+    {
+        binary.resize(header.Length);
+        valid = (bool)stream.read(binary.data(), binary.size());
+    }
+    stream.close();
+
+    unsigned int program = 0;
+    if (valid)
+    {
+        GLCall(program = glCreateProgram());
+        GLCall(glProgramBinary(program, header.Format, binary.data(), (GLsizei)binary.size()));
+        GLint linked = GL_FALSE;
+        GLCall(glGetProgramiv(program, GL_LINK_STATUS, &linked));
+        if (!linked)
+        {
+            GLCall(glDeleteProgram(program));
+            program = 0;
+        }
+    }
+
+    if (!program)
+    {
+        //Stale or broken, the program compiled instead will be stored over it
+        std::cout << "[ProgramCache] Rejected " << path << ", compiling" << std::endl;
+        std::remove(path.c_str());
+        m_Stats.Rejected++;
+        m_Stats.Misses++;
+        return 0;
+    }
+    m_Stats.Hits++;
+    return program;
+}
+
+void ProgramCache::PrepareProgram(unsigned int program)
+{
+    if (m_Enabled && IsSupported())
+    {
+        GLCall(glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+    }
+}
+
+void ProgramCache::Store(unsigned long long key, unsigned int program)
+{
+    if (!m_Enabled || !IsSupported() || program == 0)
+        return;
+
+    GLint linked = GL_FALSE, length = 0;
+    GLCall(glGetProgramiv(program, GL_LINK_STATUS, &linked));
+    GLCall(glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length));
+    if (!linked || length <= 0)
+        return;
+
+    ProgramBinaryHeader header;
+    memcpy(header.Magic, s_Magic, sizeof(s_Magic));
+    header.Version = s_Version;
+    header.Key = key;
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    GLCall(glGetProgramBinary(program, length, &length, &format, binary.data()));
+    header.Format = format;
+    header.Length = (unsigned int)length;
+
+    if (!MakeDirectory())
+        return;
+    //Written aside and renamed, so a crash or a second instance never leaves a half written file under the real name
+    std::string path = GetPath(key);
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+        if (!stream.write((const char*)&header, sizeof(header)) || !stream.write(binary.data(), header.Length))
+        {
+            std::cout << "[ProgramCache] Could not write " << temporary << std::endl;
+            return;
+        }
+    }
+    std::remove(path.c_str()); //rename doesn't replace an existing file on Windows
+    if (std::rename(temporary.c_str(), path.c_str()) != 0)
+    {
+        std::remove(temporary.c_str());
+        return;
+    }
+    m_Stats.Stored++;
+}
+
+void ProgramCache::Query()
+{
+    if (m_Queried)
+        return;
+    m_Queried = true;
+
+    m_Driver = std::string((const char*)glGetString(GL_VENDOR)) + '\n' + (const char*)glGetString(GL_RENDERER) + '\n' + (const char*)glGetString(GL_VERSION);
+    if (!GLEW_VERSION_4_1 && !GLEW_ARB_get_program_binary)
+        return;
+    GLint count = 0;
+    GLCall(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &count));
+    if (count <= 0)
+        return;
+    m_Formats.resize(count);
+    GLCall(glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, m_Formats.data()));
+    m_Supported = true;
+}
+
+std::string ProgramCache::GetPath(unsigned long long key) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", key);
+    return m_Directory + "/" + name;
+}
+
+bool ProgramCache::MakeDirectory() const
+{
+#ifdef _MSC_VER
+    bool made = _mkdir(m_Directory.c_str()) == 0 || errno == EEXIST;
+#else
+    bool made = mkdir(m_Directory.c_str(), 0755) == 0 || errno == EEXIST;
+#endif
+    if (!made)
+        std::cout << "[ProgramCache] Could not create " << m_Directory << std::endl;
+    return made;
+}
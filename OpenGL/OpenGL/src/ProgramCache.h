@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+//Linked programs kept on disk (glGetProgramBinary) so the next start loads them with glProgramBinary instead of
+//compiling and linking again. A file is named after a hash of the program's sources and of the driver's vendor,
+//renderer and version strings, so editing a shader or updating the driver just misses. A binary the driver rejects
+//is deleted and the program compiled again, callers only see Load return 0.
+//Needs GL 4.1 / ARB_get_program_binary and at least one binary format, otherwise every Load misses and Store does
+//nothing. Use it on the thread that owns the context, after glewInit.
+class ProgramCache
+{
+public:
+	struct Stats
+	{
+		unsigned int Hits = 0;
+		unsigned int Misses = 0;
+		unsigned int Rejected = 0; //Found on disk but refused by the driver, counted as misses too
+		unsigned int Stored = 0;
+	};
+private:
+	std::string m_Directory;
+	bool m_Enabled;
+	bool m_Queried; //Driver strings and binary formats are read on first use
+	bool m_Supported;
+	std::string m_Driver;
+	std::vector<int> m_Formats;
+	Stats m_Stats;
+
+	ProgramCache();
+public:
+	static ProgramCache& Get();
+
+	void SetDirectory(const std::string& directory); //Created on the first Store, its parent must exist. Default "resources/shadercache"
+	inline const std::string& GetDirectory() const { return m_Directory; }
+	void SetEnabled(bool enabled);
+	inline bool IsEnabled() const { return m_Enabled; }
+	bool IsSupported();
+
+	//Identifies a program: every stage's source, in order, plus the driver
+	unsigned long long GetKey(const std::vector<std::string>& sources);
+
+	unsigned int Load(unsigned long long key); //A linked program, or 0 to compile it
+	//Before linking a program that will be stored: some drivers only keep a binary when asked
+	void PrepareProgram(unsigned int program);
+	void Store(unsigned long long key, unsigned int program); //Only linked programs are written
+
+	inline const Stats& GetStats() const { return m_Stats; }
+	inline void ResetStats() { m_Stats = Stats(); }
+private:
+	void Query();
+	std::string GetPath(unsigned long long key) const;
+	bool MakeDirectory() const;
+};
@@ -0,0 +1,167 @@
+#include "RenderQueue.h"
+#include "Renderer.h"
+#include "Texture.h"
+#include "GLStateCache.h"
+#include "Profiler.h"
+#include "ResourceRegistry.h"
+
+static constexpr UniformID s_MVP("u_MVP");
+
+uint64_t RenderQueue::MakeKey(unsigned int layer, bool translucent, unsigned int shaderID, unsigned int textureID, float depth)
+{
+    //Depth is expected in [0,1], quantized to 24 bits
+    if (depth < 0.0f) depth = 0.0f;
+    if (depth > 1.0f) depth = 1.0f;
+    uint64_t quantizedDepth = (uint64_t)(depth * 0xffffff);
+
+    uint64_t key = (uint64_t)(layer & 0xf) << 60;
+    if (translucent)
+    {
+        //Translucent geometry must blend back to front, depth beats material
+        key |= (uint64_t)1 << 59;
+        key |= (0xffffff - quantizedDepth) << 35;
+        key |= (uint64_t)(shaderID & 0xffff) << 19;
+        key |= (uint64_t)(textureID & 0xffff) << 3;
+    }
+    else
+    {
+        key |= (uint64_t)(shaderID & 0xffff) << 43;
+        key |= (uint64_t)(textureID & 0xffff) << 27;
+        key |= quantizedDepth << 3;
+    }
+    return key;
+}
+
+void RenderQueue::Submit(const DrawPacket& packet, float depth, unsigned int layer, bool translucent)
+{
+    unsigned int textureID = packet.Tex ? packet.Tex->GetRendererID() : 0;
+    uint64_t key = MakeKey(layer, translucent, packet.Program->GetRendererID(), textureID, depth);
+
+    m_Entries.push_back({ key, (unsigned int)m_Packets.size() });
+    m_Packets.push_back(packet);
+    m_Handles.push_back(PacketHandles());
+}
+
+void RenderQueue::Submit(const PacketHandles& handles, const glm::mat4& mvp, float depth, unsigned int layer, bool translucent)
+{
+    //Resolved here only for the sort key, the pointers may move before Execute
+    DrawPacket packet = { nullptr, nullptr, nullptr, nullptr, mvp };
+    bool resolved = ResolveHandles(handles, packet);
+    ASSERT(resolved);
+    if (!resolved)
+        return;
+
+    unsigned int textureID = packet.Tex ? packet.Tex->GetRendererID() : 0;
+    uint64_t key = MakeKey(layer, translucent, packet.Program->GetRendererID(), textureID, depth);
+
+    m_Entries.push_back({ key, (unsigned int)m_Packets.size() });
+    m_Packets.push_back(packet);
+    m_Handles.push_back(handles);
+}
+
+bool RenderQueue::ResolveHandles(const PacketHandles& handles, DrawPacket& packet)
+{
+    ResourceRegistry& registry = ResourceRegistry::Get();
+    packet.VA = registry.Resolve(handles.VA);
+    packet.IB = registry.Resolve(handles.IB);
+    packet.Program = registry.Resolve(handles.Program);
+    packet.Tex = registry.Resolve(handles.Tex);
+    return packet.VA && packet.IB && packet.Program && (packet.Tex || handles.Tex.IsNull());
+}
+
+void RenderQueue::RadixSort()
+{
+    //LSD radix sort, one byte per pass. Passes where every key has the same byte are skipped,
+    //which is most of them since shader/texture IDs are small.
+    m_Scratch.resize(m_Entries.size());
+    for (unsigned int shift = 0; shift < 64; shift += 8)
+    {
+        unsigned int counts[256] = {};
+        for (const SortEntry& entry : m_Entries)
+            counts[(entry.Key >> shift) & 0xff]++;
+
+        if (counts[(m_Entries[0].Key >> shift) & 0xff] == m_Entries.size())
+            continue;
+
+        unsigned int offset = 0;
+        for (unsigned int i = 0; i < 256; i++)
+        {
+            unsigned int count = counts[i];
+            counts[i] = offset;
+            offset += count;
+        }
+        for (const SortEntry& entry : m_Entries)
+            m_Scratch[counts[(entry.Key >> shift) & 0xff]++] = entry;
+        m_Entries.swap(m_Scratch);
+    }
+}
+
+void RenderQueue::Execute()
+{
+    PROFILE_GPU_SCOPE("RenderQueue::Execute");
+    m_Stats = Stats();
+    m_Stats.Submitted = (unsigned int)m_Packets.size();
+    if (m_Packets.empty())
+        return;
+
+    {
+        PROFILE_SCOPE("RenderQueue::Sort");
+        RadixSort();
+    }
+
+    const Shader* boundShader = nullptr;
+    const VertexArray* boundVA = nullptr;
+    const IndexBuffer* boundIB = nullptr;
+    const Texture* boundTexture = nullptr;
+    unsigned int naiveBinds = 0;
+
+    for (const SortEntry& entry : m_Entries)
+    {
+        DrawPacket& packet = m_Packets[entry.Index];
+        const PacketHandles& handles = m_Handles[entry.Index];
+        if (!handles.VA.IsNull() && !ResolveHandles(handles, packet))
+        {
+            m_Stats.Stale++;
+            continue;
+        }
+        naiveBinds += packet.Tex ? 4 : 3;
+
+        if (packet.Program != boundShader)
+        {
+            packet.Program->Bind();
+            boundShader = packet.Program;
+            m_Stats.ShaderBinds++;
+        }
+        if (packet.Tex && packet.Tex != boundTexture)
+        {
+            packet.Tex->Bind(0);
+            boundTexture = packet.Tex;
+            m_Stats.TextureBinds++;
+        }
+        if (packet.VA != boundVA)
+        {
+            packet.VA->Bind();
+            boundVA = packet.VA;
+            boundIB = nullptr; //The element buffer binding belongs to the vertex array
+            m_Stats.VertexArrayBinds++;
+        }
+        if (packet.IB != boundIB)
+        {
+            packet.IB->Bind();
+            boundIB = packet.IB;
+            m_Stats.IndexBufferBinds++;
+        }
+
+        packet.Program->setUniformMat4f(s_MVP, packet.MVP);
+        GLCall(glDrawElements(GL_TRIANGLES, packet.IB->GetCount(), packet.IB->GetType(), nullptr));
+        GLStateCache::Get().OnDraw();
+        m_Stats.DrawCalls++;
+    }
+
+    unsigned int binds = m_Stats.ShaderBinds + m_Stats.TextureBinds + m_Stats.VertexArrayBinds + m_Stats.IndexBufferBinds;
+    m_Stats.BindsSaved = naiveBinds - binds;
+
+    m_Packets.clear();
+    m_Handles.clear();
+    m_Entries.clear();
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include "VertexArray.h"
+#include "IndexBuffer.h"
+#include "Shader.h"
+#include "ResourceHandle.h"
+#include "glm/glm.hpp"
+
+class Texture;
+
+//Per-frame list of draw packets. Every packet gets a 64-bit sort key, Execute radix-sorts
+//the keys and replays the packets so each shader/texture/vertex array is bound once per run.
+//
+//Key layout, most significant bit first:
+//  [63..60] layer   [59] translucent
+//  opaque:      [58..43] shader  [42..27] texture  [26..3] depth (front to back)
+//  translucent: [58..35] depth (back to front)  [34..19] shader  [18..3] texture
+class RenderQueue
+{
+public:
+	struct DrawPacket
+	{
+		const VertexArray* VA;
+		const IndexBuffer* IB;
+		Shader* Program;
+		const Texture* Tex; //Bound to slot 0, may be null
+		glm::mat4 MVP; //Uploaded as u_MVP
+	};
+
+	//Resources of a packet submitted by handle. A null Tex is untextured
+	struct PacketHandles
+	{
+		VertexArrayHandle VA;
+		IndexBufferHandle IB;
+		ShaderHandle Program;
+		TextureHandle Tex;
+	};
+
+	struct Stats
+	{
+		unsigned int Submitted = 0;
+		unsigned int DrawCalls = 0;
+		unsigned int ShaderBinds = 0;
+		unsigned int TextureBinds = 0;
+		unsigned int VertexArrayBinds = 0;
+		unsigned int IndexBufferBinds = 0;
+		unsigned int BindsSaved = 0; //Compared to one Renderer::Draw (plus texture bind) per packet
+		unsigned int Stale = 0; //Packets skipped, a handle no longer resolved at Execute
+	};
+private:
+	struct SortEntry
+	{
+		uint64_t Key;
+		unsigned int Index;
+	};
+
+	std::vector<DrawPacket> m_Packets;
+	std::vector<PacketHandles> m_Handles; //Per packet, all null for packets submitted by pointer
+	std::vector<SortEntry> m_Entries;
+	std::vector<SortEntry> m_Scratch;
+	Stats m_Stats;
+public:
+	void Submit(const DrawPacket& packet, float depth, unsigned int layer = 0, bool translucent = false);
+	//Resolved through ResourceRegistry::Get() in Execute, so Create/Destroy in between is fine: packets whose handles
+	//went stale by then are skipped. A stale handle at Submit asserts and queues nothing
+	void Submit(const PacketHandles& handles, const glm::mat4& mvp, float depth, unsigned int layer = 0, bool translucent = false);
+	void Execute(); //Sorts, issues every packet and clears the queue for the next frame
+
+	inline const Stats& GetStats() const { return m_Stats; } //Of the last Execute
+	inline unsigned int GetCount() const { return (unsigned int)m_Packets.size(); }
+
+	static uint64_t MakeKey(unsigned int layer, bool translucent, unsigned int shaderID, unsigned int textureID, float depth);
+private:
+	void RadixSort();
+	static bool ResolveHandles(const PacketHandles& handles, DrawPacket& packet);
+};
@@ -0,0 +1,154 @@
+#include "RenderThread.h"
+#include "GLStateCache.h"
+#include "Profiler.h"
+#include "DeletionQueue.h"
+#include "GpuMemory.h"
+#include "ShaderHotReload.h"
+#include "imgui/imgui_impl_glfw_gl3.h"
+#include <GLFW/glfw3.h>
+#include <chrono>
+
+FramePacket::FramePacket()
+    :ClearColor(0.0f, 0.0f, 0.0f, 1.0f), Frame()
+{
+}
+
+FramePacket::~FramePacket()
+{
+    ReleaseUI();
+}
+
+void FramePacket::CaptureUI(const ImDrawData* drawData)
+{
+    ReleaseUI();
+    if (!drawData || !drawData->Valid)
+        return;
+
+    //ImGui reuses its draw lists on the next NewFrame, the render thread needs its own copy
+    for (int i = 0; i < drawData->CmdListsCount; i++)
+        m_UILists.push_back(drawData->CmdLists[i]->CloneOutput());
+
+    UI.Valid = true;
+    UI.CmdLists = m_UILists.data();
+    UI.CmdListsCount = (int)m_UILists.size();
+    UI.TotalIdxCount = drawData->TotalIdxCount;
+    UI.TotalVtxCount = drawData->TotalVtxCount;
+
+    ImGuiIO& io = ImGui::GetIO();
+    DisplaySize = io.DisplaySize;
+    FramebufferScale = io.DisplayFramebufferScale;
+}
+
+void FramePacket::ReleaseUI()
+{
+    for (ImDrawList*& list : m_UILists)
+        IM_DELETE(list);
+    m_UILists.clear();
+    UI.Clear();
+}
+
+RenderThread::RenderThread(GLFWwindow* window, unsigned int maxQueuedFrames)
+    :m_Window(window), m_Packets(new FramePacket[maxQueuedFrames]), m_Capacity(maxQueuedFrames),
+    m_Produced(0), m_Consumed(0), m_Quit(false)
+{
+    //ImGui creates its GL objects lazily in NewFrame, which will run without a context from now on
+    ImGui_ImplGlfwGL3_CreateDeviceObjects();
+
+    glfwMakeContextCurrent(nullptr);
+    m_Thread = std::thread(&RenderThread::Run, this);
+}
+
+RenderThread::~RenderThread()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Quit = true;
+    }
+    m_PacketReady.notify_one();
+    m_Thread.join();
+
+    glfwMakeContextCurrent(m_Window);
+    //The render thread changed bindings this thread's cache knows nothing about
+    GLStateCache::Get().Invalidate();
+}
+
+FramePacket& RenderThread::BeginFrame()
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_PacketFree.wait(lock, [&] { return m_Produced - m_Consumed < m_Capacity; });
+    std::chrono::duration<double, std::milli> waited = std::chrono::high_resolution_clock::now() - start;
+    m_Stats.MainThreadWaitMs = waited.count();
+
+    FramePacket& packet = m_Packets[m_Produced % m_Capacity];
+    packet.Draws.Reset();
+    packet.ReleaseUI();
+    return packet;
+}
+
+void RenderThread::EndFrame()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Produced++;
+    }
+    m_PacketReady.notify_one();
+}
+
+RenderThread::Stats RenderThread::GetStats()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Stats;
+}
+
+void RenderThread::Run()
+{
+    glfwMakeContextCurrent(m_Window);
+    m_Uniforms.reset(new UniformBuffer());
+
+    while (true)
+    {
+        FramePacket* packet;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_PacketReady.wait(lock, [&] { return m_Quit || m_Consumed != m_Produced; });
+            if (m_Consumed == m_Produced) //Quit with nothing left to draw
+                break;
+            packet = &m_Packets[m_Consumed % m_Capacity];
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+        Profiler::Get().BeginFrame();
+        ShaderHotReload::Get().Update(); //Before the draws, so a swapped program is used this frame
+        RenderPacket(*packet);
+        Profiler::Get().EndFrame();
+        DeletionQueue::Get().EndFrame();
+        GpuMemory::Get().EndFrame();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Consumed++;
+            m_Stats.FramesRendered++;
+            m_Stats.RenderMs = elapsed.count();
+        }
+        m_PacketFree.notify_one();
+    }
+
+    m_Uniforms.reset();
+    glfwMakeContextCurrent(nullptr);
+}
+
+void RenderThread::RenderPacket(FramePacket& packet)
+{
+    GLCall(glClearColor(packet.ClearColor.r, packet.ClearColor.g, packet.ClearColor.b, packet.ClearColor.a));
+    GLCall(glClear(GL_COLOR_BUFFER_BIT));
+
+    m_Uniforms->Set(packet.Frame);
+    m_Renderer.Replay(packet.Draws);
+    m_Uniforms->EndFrame();
+    if (packet.UI.Valid)
+        ImGui_ImplGlfwGL3_RenderDrawData(&packet.UI, packet.DisplaySize, packet.FramebufferScale);
+
+    glfwSwapBuffers(m_Window);
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "CommandList.h"
+#include "Renderer.h"
+#include "UniformBuffer.h"
+#include "imgui/imgui.h"
+
+struct GLFWwindow;
+
+//Everything the render thread needs for one frame. Filled by the main thread between BeginFrame
+//and EndFrame, never touched by it again until it comes back from BeginFrame.
+//The camera travels in Frame and per-draw values inside the recorded uniforms, so the packet needs no GL state.
+struct FramePacket
+{
+	glm::vec4 ClearColor;
+	FrameUniforms Frame; //Uploaded once by the render thread, before the draws
+	CommandList Draws;
+	ImDrawData UI; //Points into m_UILists, a deep copy of ImGui's output
+	ImVec2 DisplaySize; //ImGuiIO's when the UI was captured, NewFrame changes them for the next packet
+	ImVec2 FramebufferScale;
+
+	FramePacket();
+	~FramePacket();
+
+	void CaptureUI(const ImDrawData* drawData); //Call after ImGui::Render()
+	void ReleaseUI();
+private:
+	std::vector<ImDrawList*> m_UILists;
+};
+
+//Owns the GL context on a thread of its own and renders frame packets one frame behind the main
+//thread, so a swap blocked on vsync no longer stalls the simulation. At most maxQueuedFrames packets
+//are in flight; BeginFrame blocks (back-pressure) when the render thread falls further behind.
+//
+//Create it once all resources exist: the context moves to the render thread until destruction, so the
+//main thread must not make GL calls, or use Shader uniform setters, in between.
+class RenderThread
+{
+public:
+	struct Stats
+	{
+		unsigned int FramesRendered = 0;
+		double MainThreadWaitMs = 0.0; //Time BeginFrame spent waiting on the render thread
+		double RenderMs = 0.0; //Of the last frame, swap included
+	};
+private:
+	GLFWwindow* m_Window;
+	Renderer m_Renderer;
+	std::unique_ptr<UniformBuffer> m_Uniforms; //Created and destroyed on the render thread, which owns the context
+	std::unique_ptr<FramePacket[]> m_Packets;
+	unsigned int m_Capacity;
+	unsigned int m_Produced; //Packets handed to the render thread
+	unsigned int m_Consumed; //Packets the render thread is done with
+
+	std::mutex m_Mutex;
+	std::condition_variable m_PacketReady;
+	std::condition_variable m_PacketFree;
+	bool m_Quit;
+	Stats m_Stats;
+	std::thread m_Thread;
+public:
+	RenderThread(GLFWwindow* window, unsigned int maxQueuedFrames = 2);
+	~RenderThread(); //Renders what is queued, then gives the context back to the calling thread
+
+	FramePacket& BeginFrame();
+	void EndFrame();
+
+	Stats GetStats();
+private:
+	void Run();
+	void RenderPacket(FramePacket& packet);
+};
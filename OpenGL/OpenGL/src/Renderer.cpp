@@ -1,26 +1,140 @@
 #include "Renderer.h"
-#include <iostream>
+#include "Texture.h"
+#include "GLStateCache.h"
+#include "Profiler.h"
+#include "GeometryPool.h"
+#include "ResourceRegistry.h"
+#include "VertexArrayCache.h"
 
-void GLClearError()
+void Renderer::Submit(const VertexArray& va, const IndexBuffer& ib, Shader& shader, const Texture* texture, const glm::mat4& mvp,
+    float depth, unsigned int layer, bool translucent)
 {
-    while (glGetError() != GL_NO_ERROR);
+    m_Queue.Submit({ &va, &ib, &shader, texture, mvp }, depth, layer, translucent);
 }
 
-bool GLLogCall(const char* function, const char* file, int line)
+void Renderer::Submit(VertexArrayHandle va, IndexBufferHandle ib, ShaderHandle shader, TextureHandle texture, const glm::mat4& mvp,
+    float depth, unsigned int layer, bool translucent)
 {
-    while (GLenum error = glGetError())
+    m_Queue.Submit({ va, ib, shader, texture }, mvp, depth, layer, translucent);
+}
+
+void Renderer::Execute()
+{
+    m_Queue.Execute();
+}
+
+void Renderer::Replay(const CommandList& list) const
+{
+    PROFILE_GPU_SCOPE("Renderer::Replay");
+    const std::vector<CommandList::UniformValue>& uniforms = list.GetUniforms();
+    for (const CommandList::DrawCommand& command : list.GetDraws())
     {
-        std::cout << "[OpenGL Error] (" << error << ")" << function << " " << file << " " << line << std::endl;
-        return false;
+        command.Program->Bind();
+        if (command.Tex)
+            command.Tex->Bind(0);
+
+        for (unsigned int i = command.FirstUniform; i < command.FirstUniform + command.UniformCount; i++)
+        {
+            const CommandList::UniformValue& uniform = uniforms[i];
+            switch (uniform.Type)
+            {
+            case CommandList::UniformType::Int:   command.Program->setUniform1i(uniform.Name, uniform.Int); break;
+            case CommandList::UniformType::Float: command.Program->setUniform1f(uniform.Name, uniform.Data[0]); break;
+            case CommandList::UniformType::Vec4:  command.Program->setUniform4f(uniform.Name, uniform.Data[0], uniform.Data[1], uniform.Data[2], uniform.Data[3]); break;
+            case CommandList::UniformType::Mat4:  command.Program->setUniformMat4f(uniform.Name, *(const glm::mat4*)uniform.Data); break;
+            }
+        }
+
+        Draw(*command.VA, *command.IB, *command.Program);
     }
-    return true;
 }
 
 void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const
 {
+    PROFILE_SCOPE("Renderer::Draw");
     shader.Bind();
     va.Bind();
     ib.Bind();
     //Draw call
-    GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), GL_UNSIGNED_INT, nullptr));
+    GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), ib.GetType(), nullptr));
+    GLStateCache::Get().OnDraw();
+}
+
+void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int count) const
+{
+    PROFILE_SCOPE("Renderer::Draw");
+    shader.Bind();
+    va.Bind();
+    ib.Bind();
+    GLCall(glDrawElements(GL_TRIANGLES, count, ib.GetType(), nullptr));
+    GLStateCache::Get().OnDraw();
+}
+
+void Renderer::Draw(const VertexStreamLayout& layout, const VertexBuffer* const* streams, const IndexBuffer& ib, const Shader& shader) const
+{
+    PROFILE_SCOPE("Renderer::Draw");
+    shader.Bind();
+    VertexArrayCache::Get().Bind(layout, streams);
+    ib.Bind();
+    GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), ib.GetType(), nullptr));
+    GLStateCache::Get().OnDraw();
+}
+
+void Renderer::DrawBaseVertex(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int count, int baseVertex,
+    unsigned int firstIndex) const
+{
+    PROFILE_SCOPE("Renderer::Draw");
+    shader.Bind();
+    va.Bind();
+    ib.Bind();
+    GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, count, ib.GetType(), (void*)((size_t)firstIndex * ib.GetTypeSize()), baseVertex));
+    GLStateCache::Get().OnDraw();
+}
+
+void Renderer::DrawMesh(const GeometryPool& pool, unsigned int mesh, const Shader& shader) const
+{
+    const GeometryPool::Mesh& range = pool.GetMesh(mesh);
+    DrawBaseVertex(pool.GetVertexArray(), pool.GetIndexBuffer(), shader, range.IndexCount, range.BaseVertex, range.FirstIndex);
+}
+
+void Renderer::DrawInstanced(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int instanceCount) const
+{
+    PROFILE_SCOPE("Renderer::DrawInstanced");
+    shader.Bind();
+    va.Bind();
+    ib.Bind();
+    //One call for every instance, per-instance attributes come from buffers with a divisor
+    GLCall(glDrawElementsInstanced(GL_TRIANGLES, ib.GetCount(), ib.GetType(), nullptr, instanceCount));
+    GLStateCache::Get().OnDraw();
+}
+
+void Renderer::Draw(VertexArrayHandle va, IndexBufferHandle ib, ShaderHandle shader) const
+{
+    ResourceRegistry& registry = ResourceRegistry::Get();
+    const VertexArray* vertexArray = registry.Resolve(va);
+    const IndexBuffer* indexBuffer = registry.Resolve(ib);
+    const Shader* program = registry.Resolve(shader);
+    ASSERT(vertexArray && indexBuffer && program);
+    if (vertexArray && indexBuffer && program)
+        Draw(*vertexArray, *indexBuffer, *program);
+}
+
+void Renderer::DrawInstanced(VertexArrayHandle va, IndexBufferHandle ib, ShaderHandle shader, unsigned int instanceCount) const
+{
+    ResourceRegistry& registry = ResourceRegistry::Get();
+    const VertexArray* vertexArray = registry.Resolve(va);
+    const IndexBuffer* indexBuffer = registry.Resolve(ib);
+    const Shader* program = registry.Resolve(shader);
+    ASSERT(vertexArray && indexBuffer && program);
+    if (vertexArray && indexBuffer && program)
+        DrawInstanced(*vertexArray, *indexBuffer, *program, instanceCount);
+}
+
+void Renderer::DrawIndirect(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, IndirectDrawList& list, unsigned int drawIDAttribute) const
+{
+    PROFILE_GPU_SCOPE("Renderer::DrawIndirect");
+    shader.Bind();
+    va.Bind();
+    ib.Bind();
+    list.Draw(ib.GetType(), drawIDAttribute);
 }
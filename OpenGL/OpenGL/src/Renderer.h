@@ -4,23 +4,47 @@
 #include "VertexArray.h"
 #include "IndexBuffer.h"
 #include "Shader.h"
+#include "RenderQueue.h"
+#include "IndirectDrawList.h"
+#include "CommandList.h"
+#include "GLDebug.h"
+#include "ResourceHandle.h"
 
-
-#define ASSERT(x) if (!(x)) __debugbreak(); //VS compiler MSVC
-#ifdef DEBUG
-    #define GLCall(x) GLClearError();\
-            x;\
-            ASSERT(GLLogCall(#x, __FILE__,__LINE__))
-#else
-    #define GLCall(x) x;
-#endif
-
-void GLClearError();
-bool GLLogCall(const char* function, const char* file, int line);
+class GeometryPool;
+class VertexStreamLayout;
 
 class Renderer
 {
+private:
+    RenderQueue m_Queue;
 public:
+    //Queued path: packets are sorted by layer/translucency/shader/texture/depth before any GL call.
+    //depth is in [0,1], the queue is cleared by Execute.
+    void Submit(const VertexArray& va, const IndexBuffer& ib, Shader& shader, const Texture* texture, const glm::mat4& mvp,
+        float depth = 0.0f, unsigned int layer = 0, bool translucent = false);
+    //Resolved through ResourceRegistry::Get() in Execute, packets whose handles went stale by then are skipped
+    void Submit(VertexArrayHandle va, IndexBufferHandle ib, ShaderHandle shader, TextureHandle texture, const glm::mat4& mvp,
+        float depth = 0.0f, unsigned int layer = 0, bool translucent = false);
+    void Execute();
+
+    //Issues a list recorded on any thread, in recording order. GL thread only.
+    void Replay(const CommandList& list) const;
+    inline const RenderQueue::Stats& GetQueueStats() const { return m_Queue.GetStats(); }
+
     void Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const;
+    void Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int count) const; //Only the first count indices
+    //For meshes that share buffers: count indices from firstIndex on, relative to baseVertex
+    void DrawBaseVertex(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int count, int baseVertex,
+        unsigned int firstIndex = 0) const;
+    void DrawMesh(const GeometryPool& pool, unsigned int mesh, const Shader& shader) const;
+    void DrawInstanced(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int instanceCount) const;
+    //Attributes in one buffer per stream: streams[i] goes to stream i of layout, on the vertex array VertexArrayCache
+    //keeps for that layout. Meshes of the same format don't switch vertex arrays.
+    void Draw(const VertexStreamLayout& layout, const VertexBuffer* const* streams, const IndexBuffer& ib, const Shader& shader) const;
+    //Handle versions of the above, resolved through ResourceRegistry::Get(). Stale handles assert and draw nothing.
+    void Draw(VertexArrayHandle va, IndexBufferHandle ib, ShaderHandle shader) const;
+    void DrawInstanced(VertexArrayHandle va, IndexBufferHandle ib, ShaderHandle shader, unsigned int instanceCount) const;
+    //Every mesh in the list shares va/ib/shader, one glMultiDrawElementsIndirect where supported
+    void DrawIndirect(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, IndirectDrawList& list, unsigned int drawIDAttribute) const;
     //void Draw(const VertexArray& va, const IndexBuffer& ib);
 };
\ No newline at end of file
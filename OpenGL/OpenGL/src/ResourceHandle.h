@@ -0,0 +1,37 @@
+#pragma once
+
+class VertexBuffer;
+class IndexBuffer;
+class VertexArray;
+class Shader;
+class Texture;
+
+//32-bit reference to a resource in a ResourcePool: slot index in the low bits, the slot's generation in the
+//high bits. Destroying a resource bumps its slot's generation, so old handles to it stop resolving instead of
+//pointing at whatever reuses the slot. The default handle is null.
+template<typename T>
+struct Handle
+{
+	static const unsigned int IndexBits = 20;
+	static const unsigned int IndexMask = (1u << IndexBits) - 1;
+	static const unsigned int MaxGeneration = (1u << (32 - IndexBits)) - 1;
+
+	unsigned int Value = 0;
+
+	Handle() = default;
+	Handle(unsigned int index, unsigned int generation)
+		:Value((generation << IndexBits) | index) {}
+
+	inline unsigned int GetIndex() const { return Value & IndexMask; }
+	inline unsigned int GetGeneration() const { return Value >> IndexBits; }
+	inline bool IsNull() const { return Value == 0; }
+
+	inline bool operator==(const Handle& other) const { return Value == other.Value; }
+	inline bool operator!=(const Handle& other) const { return Value != other.Value; }
+};
+
+typedef Handle<VertexBuffer> VertexBufferHandle;
+typedef Handle<IndexBuffer> IndexBufferHandle;
+typedef Handle<VertexArray> VertexArrayHandle;
+typedef Handle<Shader> ShaderHandle;
+typedef Handle<Texture> TextureHandle;
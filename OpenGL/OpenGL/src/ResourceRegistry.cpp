@@ -0,0 +1,20 @@
+#include "ResourceRegistry.h"
+#include "DeletionQueue.h"
+
+ResourceRegistry& ResourceRegistry::Get()
+{
+    //Constructed first so it is destroyed last, whatever the registry still holds at exit goes through it
+    DeletionQueue::Get();
+    static ResourceRegistry registry;
+    return registry;
+}
+
+void ResourceRegistry::Clear()
+{
+    //Vertex arrays first, they reference the buffers
+    GetPool<VertexArray>().Clear();
+    GetPool<VertexBuffer>().Clear();
+    GetPool<IndexBuffer>().Clear();
+    GetPool<Shader>().Clear();
+    GetPool<Texture>().Clear();
+}
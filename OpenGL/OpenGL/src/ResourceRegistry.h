@@ -0,0 +1,128 @@
+#pragma once
+
+#include <vector>
+#include <tuple>
+#include <utility>
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "VertexArray.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "ResourceHandle.h"
+
+//Owns resources of one type by value in a dense array, so they can be walked contiguously.
+//Slots map handles to positions in the array. Destroy moves the last resource into the gap,
+//so pointers from Resolve are only good until the next Create or Destroy on the same pool.
+template<typename T>
+class ResourcePool
+{
+private:
+	struct Slot
+	{
+		unsigned int Dense; //Position in m_Resources while the slot is live
+		unsigned int Generation; //Starts at 1 so no live handle is null
+		bool Live;
+	};
+
+	std::vector<T> m_Resources;
+	std::vector<unsigned int> m_DenseToSlot;
+	std::vector<Slot> m_Slots;
+	std::vector<unsigned int> m_FreeSlots;
+public:
+	template<typename... Args>
+	Handle<T> Create(Args&&... args)
+	{
+		unsigned int slot;
+		if (!m_FreeSlots.empty())
+		{
+			slot = m_FreeSlots.back();
+			m_FreeSlots.pop_back();
+		}
+		else
+		{
+			slot = (unsigned int)m_Slots.size();
+			ASSERT(slot <= Handle<T>::IndexMask);
+			m_Slots.push_back({ 0, 1, false });
+		}
+
+		m_Resources.emplace_back(std::forward<Args>(args)...);
+		m_DenseToSlot.push_back(slot);
+		m_Slots[slot].Dense = (unsigned int)m_Resources.size() - 1;
+		m_Slots[slot].Live = true;
+		return Handle<T>(slot, m_Slots[slot].Generation);
+	}
+
+	void Destroy(Handle<T> handle)
+	{
+		if (!IsValid(handle))
+			return;
+		Slot& slot = m_Slots[handle.GetIndex()];
+		unsigned int last = (unsigned int)m_Resources.size() - 1;
+		if (slot.Dense != last)
+		{
+			std::swap(m_Resources[slot.Dense], m_Resources[last]);
+			m_DenseToSlot[slot.Dense] = m_DenseToSlot[last];
+			m_Slots[m_DenseToSlot[last]].Dense = slot.Dense;
+		}
+		m_Resources.pop_back(); //Deletes the GL object
+		m_DenseToSlot.pop_back();
+
+		slot.Live = false;
+		//A slot that ran out of generations is retired rather than risk handing out a handle seen before
+		if (++slot.Generation <= Handle<T>::MaxGeneration)
+			m_FreeSlots.push_back(handle.GetIndex());
+	}
+
+	inline bool IsValid(Handle<T> handle) const
+	{
+		unsigned int index = handle.GetIndex();
+		return index < m_Slots.size() && m_Slots[index].Live && m_Slots[index].Generation == handle.GetGeneration();
+	}
+
+	//nullptr for null or stale handles
+	inline T* Resolve(Handle<T> handle) { return IsValid(handle) ? &m_Resources[m_Slots[handle.GetIndex()].Dense] : nullptr; }
+	inline const T* Resolve(Handle<T> handle) const { return IsValid(handle) ? &m_Resources[m_Slots[handle.GetIndex()].Dense] : nullptr; }
+
+	//Dense iteration, in no particular order
+	inline unsigned int GetCount() const { return (unsigned int)m_Resources.size(); }
+	inline typename std::vector<T>::iterator begin() { return m_Resources.begin(); }
+	inline typename std::vector<T>::iterator end() { return m_Resources.end(); }
+
+	void Clear()
+	{
+		for (unsigned int dense = 0; dense < m_Resources.size(); dense++)
+		{
+			Slot& slot = m_Slots[m_DenseToSlot[dense]];
+			slot.Live = false;
+			if (++slot.Generation <= Handle<T>::MaxGeneration)
+				m_FreeSlots.push_back(m_DenseToSlot[dense]);
+		}
+		m_Resources.clear();
+		m_DenseToSlot.clear();
+	}
+};
+
+//One pool per GPU resource type. GL thread only, like the resources themselves.
+//Clear it while the context is still current, the registry outlives main's locals.
+class ResourceRegistry
+{
+private:
+	std::tuple<ResourcePool<VertexBuffer>, ResourcePool<IndexBuffer>, ResourcePool<VertexArray>,
+		ResourcePool<Shader>, ResourcePool<Texture>> m_Pools;
+public:
+	static ResourceRegistry& Get();
+
+	template<typename T>
+	inline ResourcePool<T>& GetPool() { return std::get<ResourcePool<T>>(m_Pools); }
+
+	template<typename T, typename... Args>
+	inline Handle<T> Create(Args&&... args) { return GetPool<T>().Create(std::forward<Args>(args)...); }
+
+	template<typename T>
+	inline void Destroy(Handle<T> handle) { GetPool<T>().Destroy(handle); }
+
+	template<typename T>
+	inline T* Resolve(Handle<T> handle) { return GetPool<T>().Resolve(handle); }
+
+	void Clear();
+};
@@ -4,22 +4,44 @@
 #include <fstream>
 #include <string>
 #include <sstream>
+#include <memory>
 #include "Renderer.h"
 #include "VertexBuffer.h"
 #include "VertexBufferLayout.h"
 #include "IndexBuffer.h"
 #include "VertexArray.h"
 #include "Shader.h"
+#include "ShaderHotReload.h"
 #include "Texture.h"
+#include "GLStateCache.h"
+#include "RenderThread.h"
+#include "Profiler.h"
+#include "ResourceRegistry.h"
+#include "DeletionQueue.h"
+#include "GpuMemory.h"
+#include "UniformBuffer.h"
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #include "imgui/imgui.h"
 #include "imgui/imgui_impl_glfw_gl3.h"
 
-int main(void)
+int main(int argc, char** argv)
 {
     GLFWwindow* window;
 
+    //--render-thread : GL submission and swap run on their own thread, one frame behind the updates
+    //--vram-budget MB : warn when the renderer's GPU memory goes past MB, --vram-limit MB : refuse allocations past it
+    bool useRenderThread = false;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--render-thread")
+            useRenderThread = true;
+        else if ((arg == "--vram-budget" || arg == "--vram-limit") && i + 1 < argc)
+            GpuMemory::Get().SetTotalBudget(std::stoull(argv[++i]) * 1024 * 1024,
+                arg == "--vram-limit" ? GpuMemory::BudgetAction::Refuse : GpuMemory::BudgetAction::Warn);
+    }
+
     /* Initialize the library */
     if (!glfwInit())
         return -1;
@@ -28,6 +50,9 @@ int main(void)
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3); //VERSION 3.3
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE); //Core Profile
+#ifdef GL_CHECKS_ENABLED
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE); //Drivers only report everything to KHR_debug in a debug context
+#endif
 
 
     /* Create a windowed mode window and its OpenGL context */
@@ -48,6 +73,9 @@ int main(void)
     }
 
     std::cout << glGetString(GL_VERSION) << std::endl;
+#ifdef GL_CHECKS_ENABLED
+    GLDebug::Init();
+#endif
     /* 
     -0.5f, -0.5f, 0.0f, 0.0f,//Vertx 0
         0.5f, -0.5f, 1.0f, 0.0f,//Vertx 1
@@ -90,7 +118,9 @@ int main(void)
     glm::mat4 proj = glm::ortho(0.0f,960.0f,0.0f,540.0f,-1.0f,1.0f);
     glm::mat4 view = glm::translate(glm::mat4(1.0f),glm::vec3(-100,0,0));
 
-    Shader shader("resources/shaders/Basic.shader");
+    //The camera comes from the Frame uniform block, set once a frame for every program that declares it
+    Shader shader("resources/shaders/Scene.shader");
+    ShaderHotReload::Get().Watch(shader); //Save Scene.shader while running to see the change
     shader.Bind();
     shader.setUniform4f("u_Color", 0.2f, 0.3f, 0.8f, 1.0f);
     
@@ -106,6 +136,7 @@ int main(void)
     shader.Unbind();
 
     Renderer renderer;
+    std::unique_ptr<UniformBuffer> uniforms(new UniformBuffer()); //Without a render thread, which has its own
 
     ImGui::CreateContext();
     ImGui_ImplGlfwGL3_Init(window, true);
@@ -113,28 +144,64 @@ int main(void)
 
     glm::vec3 translation(200, 200, 0);
 
+    //From here on the render thread owns the context
+    std::unique_ptr<RenderThread> renderThread;
+    if (useRenderThread)
+    {
+        uniforms.reset(); //Its buffer belongs to this thread's context
+        renderThread.reset(new RenderThread(window));
+    }
+
     float redChannel = 0.0f;
     float increment = 0.05f;
     /* Loop until the user closes the window */
     while (!glfwWindowShouldClose(window))
     {
+        //Waits when the render thread is too far behind
+        FramePacket* packet = renderThread ? &renderThread->BeginFrame() : nullptr;
+        //With a render thread the frames are measured over there
+        if (!packet)
+            Profiler::Get().BeginFrame();
+
         /* Render here */
-        glClear(GL_COLOR_BUFFER_BIT);
+        if (!packet)
+        {
+            ShaderHotReload::Get().Update();
+            glClear(GL_COLOR_BUFFER_BIT);
+        }
         ImGui_ImplGlfwGL3_NewFrame();
 
+        FrameUniforms frame;
+        frame.Projection = proj;
+        frame.View = view;
+        frame.ViewProjection = proj * view;
+        frame.CameraPosition = glm::vec3(100, 0, 0); //view moves the world by -100 in x
+        frame.Time = (float)glfwGetTime();
         glm::mat4 model = glm::translate(glm::mat4(1.0f), translation);
-        glm::mat4 mvp = proj * view * model;
-
-        //=================Way the we draw things========================
-        //binding the shader
-        shader.Bind();
-        //Setup the uniforms 
-        shader.setUniform4f("u_Color", redChannel, 0.3f, 0.8f, 1.0f);
-        shader.setUniformMat4f("u_MVP", mvp);
-        //Draw call
-        renderer.Draw(va,ib,shader);
-        GLCall(glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr));
-        //=================================================================================
+
+        if (packet)
+        {
+            //Same draw, recorded here and issued by the render thread
+            packet->Draws.SetUniform4f("u_Color", glm::vec4(redChannel, 0.3f, 0.8f, 1.0f));
+            packet->Frame = frame;
+            packet->Draws.SetUniformMat4f("u_Model", model);
+            packet->Draws.Draw(va, ib, shader, &texture);
+        }
+        else
+        {
+            //=================Way the we draw things========================
+            //The camera, once for the whole frame
+            uniforms->Set(frame);
+            //binding the shader
+            shader.Bind();
+            //Setup the uniforms 
+            shader.setUniform4f("u_Color", redChannel, 0.3f, 0.8f, 1.0f);
+            shader.setUniformMat4f("u_Model", model);
+            //Draw call
+            renderer.Draw(va,ib,shader);
+            GLCall(glDrawElements(GL_TRIANGLES, 6, ib.GetType(), nullptr));
+            //=================================================================================
+        }
 
         if (redChannel > 1.0f)
             increment -= 0.2f;
@@ -148,17 +215,52 @@ int main(void)
             
 
             ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+            if (renderThread)
+            {
+                RenderThread::Stats renderStats = renderThread->GetStats();
+                ImGui::Text("Render thread %.3f ms/frame, main thread waited %.3f ms", renderStats.RenderMs, renderStats.MainThreadWaitMs);
+            }
+            else
+            {
+                const GLStateCache::Stats& bindStats = GLStateCache::Get().GetStats();
+                ImGui::Text("Binds %u issued, %u skipped", bindStats.Issued, bindStats.Skipped);
+            }
+            DeletionQueue::Stats deletionStats = DeletionQueue::Get().GetStats();
+            ImGui::Text("Deletion queue %u objects, %.1f KB deferred", deletionStats.QueueDepth, deletionStats.DeferredBytes / 1024.0);
         }
+        Profiler::Get().OnImGuiRender();
+        GpuMemory::Get().OnImGuiRender();
 
-        ImGui::Render();
-        ImGui_ImplGlfwGL3_RenderDrawData(ImGui::GetDrawData());
+        if (packet)
+        {
+            ImGui::Render();
+            packet->CaptureUI(ImGui::GetDrawData());
+            renderThread->EndFrame();
+        }
+        else
+        {
+            GLStateCache::Get().ResetStats();
+            ImGui::Render();
+            ImGui_ImplGlfwGL3_RenderDrawData(ImGui::GetDrawData());
+            Profiler::Get().EndFrame();
+            uniforms->EndFrame();
+            DeletionQueue::Get().EndFrame();
+            GpuMemory::Get().EndFrame();
 
-         /* Swap front and back buffers */
-        glfwSwapBuffers(window);
+             /* Swap front and back buffers */
+            glfwSwapBuffers(window);
+        }
         /* Poll for and process events */
         glfwPollEvents();
     }
 
+    //Takes the context back, ImGui and the resources below delete GL objects
+    renderThread.reset();
+    uniforms.reset();
+    Profiler::Get().ReleaseQueries();
+    ResourceRegistry::Get().Clear();
+    DeletionQueue::Get().Flush();
+
     ImGui_ImplGlfwGL3_Shutdown();
     ImGui::DestroyContext();
     glfwTerminate();
@@ -1,56 +1,274 @@
 #include "Shader.h"
+#include "GLStateCache.h"
+#include "Profiler.h"
+#include "DeletionQueue.h"
+#include "GpuMemory.h"
+#include "ProgramCache.h"
+#include "ShaderHotReload.h"
+#include "UniformBuffer.h"
+#include <utility>
+#include <algorithm>
+#include <vector>
 
 
-Shader::Shader(const std::string& filepath)
-	:m_FilePath(filepath), m_RendererID(0)
+Shader::Shader(const std::string& filepath, bool wait)
+	:m_FilePath(filepath), m_RendererID(0), m_Status(Status::Compiling), m_HotReload(false)
 {
-    ShaderProgramSource source = ParseShader(filepath);
-    m_RendererID = CreateShader(source.VertexSource, source.FragmentSource);
+    Start(ParseShader(filepath));
+    if (wait)
+        Poll(true);
 }
 
 Shader::~Shader(){
-    GLCall(glDeleteProgram(m_RendererID));
+    if (m_HotReload)
+        ShaderHotReload::Get().Unwatch(*this);
+    Discard();
+    DeletionQueue::Get().Enqueue(DeletionQueue::Type::Program, m_RendererID);
+}
+
+Shader::Shader(Shader&& other) noexcept
+    :m_FilePath(std::move(other.m_FilePath)), m_RendererID(other.m_RendererID), m_Uniforms(std::move(other.m_Uniforms)),
+    m_UniformSlots(std::move(other.m_UniformSlots)), m_MissingUniforms(std::move(other.m_MissingUniforms)),
+    m_Status(other.m_Status), m_Build(other.m_Build), m_HotReload(other.m_HotReload)
+{
+    other.m_RendererID = 0;
+    other.m_Status = Status::Failed;
+    other.m_Build = Build();
+    other.m_HotReload = false;
+    if (m_HotReload)
+        ShaderHotReload::Get().Exchange(other, *this);
+}
+
+Shader& Shader::operator=(Shader&& other) noexcept
+{
+    //Swapped, other's destructor deletes the program this one held
+    std::swap(m_FilePath, other.m_FilePath);
+    std::swap(m_RendererID, other.m_RendererID);
+    std::swap(m_Uniforms, other.m_Uniforms);
+    std::swap(m_UniformSlots, other.m_UniformSlots);
+    std::swap(m_MissingUniforms, other.m_MissingUniforms);
+    std::swap(m_Status, other.m_Status);
+    std::swap(m_Build, other.m_Build);
+    std::swap(m_HotReload, other.m_HotReload);
+    if (m_HotReload || other.m_HotReload)
+        ShaderHotReload::Get().Exchange(*this, other);
+    return *this;
+}
+
+bool Shader::Poll(bool wait)
+{
+    if (m_Build.Program == 0)
+        return true;
+    if (!wait && IsParallelCompileSupported())
+    {
+        GLint done = GL_FALSE;
+        GLCall(glGetProgramiv(m_Build.Program, GL_COMPLETION_STATUS_KHR, &done));
+        if (!done)
+            return false;
+    }
+
+    //Both stages are checked so both logs are printed
+    bool compiled = CheckCompile(m_Build.VertexShader, GL_VERTEX_SHADER);
+    compiled = CheckCompile(m_Build.FragmentShader, GL_FRAGMENT_SHADER) && compiled;
+    GLint linked = GL_FALSE;
+    GLCall(glGetProgramiv(m_Build.Program, GL_LINK_STATUS, &linked));
+    if (compiled && !linked)
+    {
+        int length;
+        GLCall(glGetProgramiv(m_Build.Program, GL_INFO_LOG_LENGTH, &length));
+        std::string message(std::max(length, 1), '\0');
+        GLCall(glGetProgramInfoLog(m_Build.Program, length, &length, &message[0]));
+        std::cout << "Failed to link " << m_FilePath << std::endl;
+        std::cout << message.c_str() << std::endl;
+    }
+
+    unsigned int program = m_Build.Program;
+    unsigned long long cacheKey = m_Build.CacheKey;
+    glDeleteShader(m_Build.VertexShader); //Delete the intermediate files
+    glDeleteShader(m_Build.FragmentShader);
+    m_Build = Build();
+    if (!compiled || !linked)
+    {
+        GLCall(glDeleteProgram(program));
+        if (m_Status == Status::Compiling)
+            m_Status = Status::Failed;
+        else
+            std::cout << "[Shader] Keeping the running program of " << m_FilePath << std::endl;
+        return true;
+    }
+    ProgramCache::Get().Store(cacheKey, program);
+    Swap(program);
+    return true;
+}
+
+void Shader::Reload(const ShaderProgramSource& source)
+{
+    Start(source);
+}
+
+void Shader::Reload()
+{
+    Start(ParseShader(m_FilePath));
+}
+
+bool Shader::IsParallelCompileSupported()
+{
+    return GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile;
 }
 
 void Shader::Bind() const
 {
-    GLCall(glUseProgram(m_RendererID));
+    //Binding a program that is still building would make the driver wait anyway. A reload doesn't, the running program is used
+    if (m_Status == Status::Compiling)
+        const_cast<Shader*>(this)->Poll(true);
+    GLStateCache::Get().UseProgram(m_RendererID);
 }
 
 void Shader::Unbind() const
 {
-    GLCall(glUseProgram(0));
+    GLStateCache::Get().UseProgram(0);
 }
 
-void Shader::setUniform1i(const std::string& name, int value) {
+void Shader::setUniform1i(UniformID name, int value) {
+    PROFILE_SCOPE("Shader::setUniform");
     GLCall(glUniform1i(GetUniformLocation(name), value));
 }
 
-void Shader::setUniform1f(const std::string& name, float value) {
+void Shader::setUniform1iv(UniformID name, int count, const int* values) {
+    PROFILE_SCOPE("Shader::setUniform");
+    GLCall(glUniform1iv(GetUniformLocation(name), count, values));
+}
+
+void Shader::setUniform1f(UniformID name, float value) {
+    PROFILE_SCOPE("Shader::setUniform");
     GLCall(glUniform1f(GetUniformLocation(name), value));
 }
 
-void Shader::setUniform4f(const std::string& name, float v0, float v1, float v2, float v3)
+void Shader::setUniform4f(UniformID name, float v0, float v1, float v2, float v3)
 {
+    PROFILE_SCOPE("Shader::setUniform");
     GLCall(glUniform4f(GetUniformLocation(name),v0,v1,v2,v3));
 }
 
-void Shader::setUniformMat4f(const std::string& name, const glm::mat4& matrix)
+void Shader::setUniformMat4f(UniformID name, const glm::mat4& matrix)
 {
+    PROFILE_SCOPE("Shader::setUniform");
     GLCall(glUniformMatrix4fv(GetUniformLocation(name),1,GL_FALSE,&matrix[0][0]));
 }
 
-int Shader::GetUniformLocation(const std::string& name)
+int Shader::GetUniformLocation(UniformID name)
 {
-    if (m_UniformLocationCache.find(name) != m_UniformLocationCache.end())
-        return m_UniformLocationCache[name];
+    if (m_Status == Status::Compiling)
+        Poll(true);
+    if (m_RendererID == 0)
+        return -1; //Failed to build, glUniform ignores -1
+    const Uniform* uniform = FindUniform(name.GetHash());
+    if (uniform)
+        return uniform->Location;
+
+    if (std::find(m_MissingUniforms.begin(), m_MissingUniforms.end(), name.GetHash()) == m_MissingUniforms.end())
+    {
+        std::cout << "[Shader] No uniform " << name.GetName() << " in " << m_FilePath << std::endl;
+        m_MissingUniforms.push_back(name.GetHash());
+    }
+    return -1;
+}
+
+const Shader::Uniform* Shader::FindUniform(unsigned int hash) const
+{
+    if (m_UniformSlots.empty())
+        return nullptr;
+    size_t mask = m_UniformSlots.size() - 1;
+    for (size_t slot = hash & mask;; slot = (slot + 1) & mask)
+    {
+        int index = m_UniformSlots[slot];
+        if (index == -1)
+            return nullptr; //The table is never full, a miss ends on an empty slot
+        if (m_Uniforms[index].Hash == hash)
+            return &m_Uniforms[index];
+    }
+}
+
+void Shader::Reflect()
+{
+    m_Uniforms.clear();
+    m_UniformSlots.clear();
+
+    GLint count = 0, maxLength = 0;
+    GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORMS, &count));
+    GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength));
+    std::vector<char> buffer(maxLength + 1);
+    for (GLint i = 0; i < count; i++)
+    {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        GLCall(glGetActiveUniform(m_RendererID, i, (GLsizei)buffer.size(), &length, &size, &type, buffer.data()));
+        std::string name(buffer.data(), length);
+        GLCall(int location = glGetUniformLocation(m_RendererID, name.c_str()));
+        if (location == -1)
+            continue; //In a uniform block, not set one by one
+
+        //Arrays are reported as "u_Textures[0]": found by the bare name and by each element's
+        bool array = name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0;
+        if (array)
+            name.resize(name.size() - 3);
+        m_Uniforms.push_back({ name, UniformID::Hash(name.c_str()), location, type, array ? size : 1 });
+        for (GLint element = 0; array && element < size; element++)
+        {
+            std::string elementName = name + "[" + std::to_string(element) + "]";
+            GLCall(int elementLocation = glGetUniformLocation(m_RendererID, elementName.c_str()));
+            m_Uniforms.push_back({ elementName, UniformID::Hash(elementName.c_str()), elementLocation, type, 1 });
+        }
+    }
 
-    GLCall(int location = glGetUniformLocation(m_RendererID, name.c_str()));
-    if (location == -1)
-        std::cout << "Warning : " << name << "doesn't exist!" << std::endl;
+    //At most half full, so probes stay short and every miss finds an empty slot
+    size_t slots = 8;
+    while (slots < m_Uniforms.size() * 2)
+        slots *= 2;
+    m_UniformSlots.assign(slots, -1);
+    size_t mask = slots - 1;
+    for (size_t i = 0; i < m_Uniforms.size(); i++)
+    {
+        const Uniform& uniform = m_Uniforms[i];
+        if (const Uniform* other = FindUniform(uniform.Hash))
+        {
+            std::cout << "[Shader] Uniforms " << other->Name << " and " << uniform.Name << " in " << m_FilePath
+                << " have the same hash, " << uniform.Name << " can't be set" << std::endl;
+            continue;
+        }
+        size_t slot = uniform.Hash & mask;
+        while (m_UniformSlots[slot] != -1)
+            slot = (slot + 1) & mask;
+        m_UniformSlots[slot] = (int)i;
+    }
 
-    m_UniformLocationCache[name] = location;
-    return location;
+    //Blocks read from the binding point UniformBuffer registered for their name, shared by every program
+    GLint blocks = 0;
+    GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORM_BLOCKS, &blocks));
+    if (blocks)
+    {
+        GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLength));
+        buffer.resize(maxLength + 1);
+    }
+    for (GLint i = 0; i < blocks; i++)
+    {
+        GLsizei length = 0;
+        GLint dataSize = 0;
+        GLCall(glGetActiveUniformBlockName(m_RendererID, i, (GLsizei)buffer.size(), &length, buffer.data()));
+        GLCall(glGetActiveUniformBlockiv(m_RendererID, i, GL_UNIFORM_BLOCK_DATA_SIZE, &dataSize));
+        std::string name(buffer.data(), length);
+        unsigned int binding, size;
+        if (!UniformBuffer::FindBlock(name, binding, size))
+        {
+            std::cout << "[Shader] Uniform block " << name << " in " << m_FilePath << " has no binding point registered" << std::endl;
+            continue;
+        }
+        if ((unsigned int)dataSize > size)
+            std::cout << "[Shader] Uniform block " << name << " in " << m_FilePath << " is " << dataSize
+                << " bytes, larger than the " << size << " registered: is it declared std140, with the same members?" << std::endl;
+        GLCall(glUniformBlockBinding(m_RendererID, i, binding));
+    }
 }
 
 unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
@@ -58,8 +276,12 @@ unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
     unsigned int id = glCreateShader(type);
     const char* src = source.c_str(); //&source[0]
     glShaderSource(id, 1, &src, nullptr);
-    glCompileShader(id); //Compile the shader
+    glCompileShader(id); //Compile the shader, the result is only asked for in CheckCompile
+    return id;
+}
 
+bool Shader::CheckCompile(unsigned int id, unsigned int type)
+{
     //Error handelling
     int result;
     glGetShaderiv(id, GL_COMPILE_STATUS, &result);
@@ -68,30 +290,163 @@ unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
         glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length);
         char* message = (char*)alloca(length * sizeof(char));
         glGetShaderInfoLog(id, length, &length, message);
-        std::cout << "Failed to compile " << (type == GL_VERTEX_SHADER ? "vertex" : "fragment") << std::endl;
+        std::cout << "Failed to compile " << (type == GL_VERTEX_SHADER ? "vertex" : "fragment") << " in " << m_FilePath << std::endl;
         std::cout << message << std::endl;
-        glDeleteShader(id);
-        return 0;
+        return false;
     }
-
-    return id;
+    return true;
 }
 
+//Issues the compiles and the link without asking how they went, so a driver with parallel compile can work on them
+//while this thread carries on. Poll checks the results. No glValidateProgram: it answers for the state bound at the
+//time of the call, which at load time says nothing about the draws to come.
 unsigned int Shader::CreateShader(const std::string& vertexShader, const std::string& fragmentShader)
 {
     unsigned int program = glCreateProgram();
-    unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShader);
-    unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShader);
+    m_Build.VertexShader = CompileShader(GL_VERTEX_SHADER, vertexShader);
+    m_Build.FragmentShader = CompileShader(GL_FRAGMENT_SHADER, fragmentShader);
 
-    glAttachShader(program, vs);
-    glAttachShader(program, fs);
+    glAttachShader(program, m_Build.VertexShader);
+    glAttachShader(program, m_Build.FragmentShader);
+    ProgramCache::Get().PrepareProgram(program);
     glLinkProgram(program);
-    glValidateProgram(program);
+    return program;
+}
 
-    glDeleteShader(vs); //Delete the intermediate files
-    glDeleteShader(fs);
+void Shader::Start(const ShaderProgramSource& source)
+{
+    Discard(); //A reload that hadn't finished is out of date
+    ProgramCache& cache = ProgramCache::Get();
+    unsigned long long cacheKey = cache.GetKey({ source.VertexSource, source.FragmentSource });
+    unsigned int program = cache.Load(cacheKey);
+    if (program)
+    {
+        Swap(program);
+        return;
+    }
+    m_Build.Program = CreateShader(source.VertexSource, source.FragmentSource);
+    m_Build.CacheKey = cacheKey;
+}
 
-    return program;
+void Shader::Discard()
+{
+    //Deleting shader objects and a program nothing has drawn with never waits for the GPU
+    if (m_Build.Program == 0)
+        return;
+    glDeleteShader(m_Build.VertexShader);
+    glDeleteShader(m_Build.FragmentShader);
+    GLCall(glDeleteProgram(m_Build.Program));
+    m_Build = Build();
+}
+
+void Shader::Swap(unsigned int program)
+{
+    unsigned int previous = m_RendererID;
+    std::vector<Uniform> previousUniforms;
+    previousUniforms.swap(m_Uniforms);
+    m_RendererID = program;
+    m_Status = Status::Ready;
+    Reflect();
+    m_MissingUniforms.clear(); //The new program may have them
+    if (previous)
+    {
+        CopyUniforms(previous, previousUniforms);
+        DeletionQueue::Get().Enqueue(DeletionQueue::Type::Program, previous);
+    }
+
+    //The driver's binary is the nearest thing to a size a program has, 0 where it can't be queried
+    GLint binaryLength = 0;
+    if (GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary)
+    {
+        GLCall(glGetProgramiv(m_RendererID, GL_PROGRAM_BINARY_LENGTH, &binaryLength));
+    }
+    GpuMemory::Get().Allocate(GpuMemory::Category::Program, m_RendererID, binaryLength, m_FilePath, false);
+}
+
+//How a uniform's value is read and written: 'f' float, 'i' int (bool and samplers too), 'u' unsigned, 'm' square matrix
+static bool GetUniformKind(GLenum type, char& kind, int& components)
+{
+    switch (type)
+    {
+        case GL_FLOAT:             kind = 'f'; components = 1; return true;
+        case GL_FLOAT_VEC2:        kind = 'f'; components = 2; return true;
+        case GL_FLOAT_VEC3:        kind = 'f'; components = 3; return true;
+        case GL_FLOAT_VEC4:        kind = 'f'; components = 4; return true;
+        case GL_INT: case GL_BOOL: kind = 'i'; components = 1; return true;
+        case GL_INT_VEC2: case GL_BOOL_VEC2: kind = 'i'; components = 2; return true;
+        case GL_INT_VEC3: case GL_BOOL_VEC3: kind = 'i'; components = 3; return true;
+        case GL_INT_VEC4: case GL_BOOL_VEC4: kind = 'i'; components = 4; return true;
+        case GL_UNSIGNED_INT:      kind = 'u'; components = 1; return true;
+        case GL_UNSIGNED_INT_VEC2: kind = 'u'; components = 2; return true;
+        case GL_UNSIGNED_INT_VEC3: kind = 'u'; components = 3; return true;
+        case GL_UNSIGNED_INT_VEC4: kind = 'u'; components = 4; return true;
+        case GL_FLOAT_MAT2:        kind = 'm'; components = 2; return true;
+        case GL_FLOAT_MAT3:        kind = 'm'; components = 3; return true;
+        case GL_FLOAT_MAT4:        kind = 'm'; components = 4; return true;
+        case GL_SAMPLER_1D: case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE: case GL_SAMPLER_2D_SHADOW:
+        case GL_SAMPLER_2D_ARRAY: case GL_SAMPLER_BUFFER: case GL_SAMPLER_2D_MULTISAMPLE:
+        case GL_INT_SAMPLER_2D: case GL_INT_SAMPLER_BUFFER: case GL_UNSIGNED_INT_SAMPLER_2D: case GL_UNSIGNED_INT_SAMPLER_BUFFER:
+            kind = 'i'; components = 1; return true;
+        default:
+            return false;
+    }
+}
+
+void Shader::CopyUniforms(unsigned int from, const std::vector<Uniform>& uniforms) const
+{
+    //Only what both programs declare with the same type, element by element for arrays
+    GLStateCache& cache = GLStateCache::Get();
+    unsigned int previous = cache.GetProgram();
+    cache.UseProgram(m_RendererID);
+
+    for (const Uniform& uniform : uniforms)
+    {
+        const Uniform* target = FindUniform(uniform.Hash);
+        char kind;
+        int components;
+        if (uniform.Size != 1 || !target || target->Type != uniform.Type || !GetUniformKind(uniform.Type, kind, components))
+            continue;
+        {
+            GLint source = uniform.Location;
+            GLint destination = target->Location;
+            float floats[16];
+            int ints[4];
+            unsigned int uints[4];
+            switch (kind)
+            {
+                case 'f':
+                    GLCall(glGetUniformfv(from, source, floats));
+                    if (components == 1)      { GLCall(glUniform1fv(destination, 1, floats)); }
+                    else if (components == 2) { GLCall(glUniform2fv(destination, 1, floats)); }
+                    else if (components == 3) { GLCall(glUniform3fv(destination, 1, floats)); }
+                    else                      { GLCall(glUniform4fv(destination, 1, floats)); }
+                    break;
+                case 'i':
+                    GLCall(glGetUniformiv(from, source, ints));
+                    if (components == 1)      { GLCall(glUniform1iv(destination, 1, ints)); }
+                    else if (components == 2) { GLCall(glUniform2iv(destination, 1, ints)); }
+                    else if (components == 3) { GLCall(glUniform3iv(destination, 1, ints)); }
+                    else                      { GLCall(glUniform4iv(destination, 1, ints)); }
+                    break;
+                case 'u':
+                    GLCall(glGetUniformuiv(from, source, uints));
+                    if (components == 1)      { GLCall(glUniform1uiv(destination, 1, uints)); }
+                    else if (components == 2) { GLCall(glUniform2uiv(destination, 1, uints)); }
+                    else if (components == 3) { GLCall(glUniform3uiv(destination, 1, uints)); }
+                    else                      { GLCall(glUniform4uiv(destination, 1, uints)); }
+                    break;
+                case 'm':
+                    GLCall(glGetUniformfv(from, source, floats));
+                    if (components == 2)      { GLCall(glUniformMatrix2fv(destination, 1, GL_FALSE, floats)); }
+                    else if (components == 3) { GLCall(glUniformMatrix3fv(destination, 1, GL_FALSE, floats)); }
+                    else                      { GLCall(glUniformMatrix4fv(destination, 1, GL_FALSE, floats)); }
+                    break;
+            }
+        }
+    }
+    //Unknown after Invalidate, or once the bound program was deleted: this one is as good as any
+    if (previous != GLStateCache::Unknown && previous != from)
+        cache.UseProgram(previous);
 }
 
 ShaderProgramSource Shader::ParseShader(const std::string& filepath)
@@ -115,7 +470,7 @@ ShaderProgramSource Shader::ParseShader(const std::string& filepath)
             else if (line.find("fragment") != std::string::npos)
                 type = ShaderType::FRAGMENT;
         }
-        else
+        else if (type != ShaderType::NONE)
         {
             ss[(int)type] << line << '\n';
         }
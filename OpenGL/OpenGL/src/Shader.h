@@ -4,21 +4,11 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
-#include <unordered_map>
+#include <vector>
 #include "glm/glm.hpp"
 
-#include <GL/glew.h>
-#define ASSERT(x) if (!(x)) __debugbreak(); //VS compiler MSVC
-#ifdef DEBUG
-#define GLCall(x) GLClearError();\
-            x;\
-            ASSERT(GLLogCall(#x, __FILE__,__LINE__))
-#else
-#define GLCall(x) x;
-#endif
-
-void GLClearError();
-bool GLLogCall(const char* function, const char* file, int line);
+#include "GLDebug.h"
+#include "UniformID.h"
 
 struct ShaderProgramSource
 {
@@ -28,26 +18,91 @@ struct ShaderProgramSource
 
 class Shader
 {
+	friend class ShaderHotReload;
+public:
+	enum class Status { Compiling, Ready, Failed };
 private:
+	//A compile and link in flight: the first one, or a reload while m_RendererID keeps drawing
+	struct Build
+	{
+		unsigned int Program = 0;
+		unsigned int VertexShader = 0; //Kept until the build is checked
+		unsigned int FragmentShader = 0;
+		unsigned long long CacheKey = 0;
+	};
+
+	//An active uniform, reflected once the program links. Arrays have an entry for the whole array (Size elements,
+	//found by the name without [0]) and one per element
+	struct Uniform
+	{
+		std::string Name;
+		unsigned int Hash;
+		int Location;
+		unsigned int Type;
+		int Size;
+	};
+
 	std::string m_FilePath;
 	unsigned int m_RendererID;
-	std::unordered_map<std::string, int> m_UniformLocationCache;
+	std::vector<Uniform> m_Uniforms;
+	std::vector<int> m_UniformSlots; //Open addressing on the hash, index into m_Uniforms or -1. Power of two
+	std::vector<unsigned int> m_MissingUniforms; //Hashes already warned about
+	Status m_Status;
+	Build m_Build;
+	bool m_HotReload; //Registered with ShaderHotReload
 public:
-	Shader(const std::string& filepath);
+	//wait = false only starts the compile and link and returns, Poll finishes the program. Binding it or setting
+	//a uniform before then waits for it. A program that fails to build is logged and left empty (0).
+	Shader(const std::string& filepath, bool wait = true);
 	~Shader();
 
+	//Owns the GL program: move-only, a moved-from Shader is empty
+	Shader(const Shader&) = delete;
+	Shader& operator=(const Shader&) = delete;
+	Shader(Shader&& other) noexcept;
+	Shader& operator=(Shader&& other) noexcept;
+
 	void Bind() const;
 	void Unbind() const;
 
-	//Set unifroms
-	void setUniform1i(const std::string& name, int value);
-	void setUniform1f(const std::string& name, float value);
-	void setUniform4f(const std::string& name, float v0, float v1, float v2, float v3);
-	void setUniformMat4f(const std::string& name, const glm::mat4& matrix);
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline const std::string& GetFilePath() const { return m_FilePath; }
+
+	//True once nothing is building. Without wait it only asks the driver where KHR_parallel_shader_compile
+	//is supported; elsewhere there is no asking, it always finishes the build.
+	bool Poll(bool wait = false);
+	inline Status GetStatus() const { return m_Status; }
+	inline bool IsReady() const { return m_Status == Status::Ready; }
+
+	//Builds the program again, without waiting, and swaps it in once it links (Poll). The running program draws until
+	//then, and stays if the new one fails. Uniform values carry over to the new program, uniforms are reflected again.
+	void Reload(const ShaderProgramSource& source);
+	void Reload(); //From the file
+	inline bool IsReloading() const { return m_Status != Status::Compiling && m_Build.Program != 0; }
+
+	static ShaderProgramSource ParseShader(const std::string& filepath); //Any thread, no GL calls
+
+	static bool IsParallelCompileSupported();
+
+	//Set unifroms. A lookup in the reflected table, no allocation. A uniform the program doesn't have is reported once.
+	//Uniform blocks aren't set here: the program reads them from the binding point UniformBuffer registered for the
+	//block's name, set up when it links.
+	void setUniform1i(UniformID name, int value);
+	void setUniform1iv(UniformID name, int count, const int* values);
+	void setUniform1f(UniformID name, float value);
+	void setUniform4f(UniformID name, float v0, float v1, float v2, float v3);
+	void setUniformMat4f(UniformID name, const glm::mat4& matrix);
 
+	int GetUniformLocation(UniformID name); //-1 if the program has no such uniform, glUniform ignores it
+	inline unsigned int GetUniformCount() const { return (unsigned int)m_Uniforms.size(); }
 private:
-	int GetUniformLocation(const std::string& name);
+	const Uniform* FindUniform(unsigned int hash) const;
+	void Reflect(); //Uniforms, and the binding points of uniform blocks
 	unsigned int CompileShader(unsigned int type, const std::string& source);
+	bool CheckCompile(unsigned int id, unsigned int type);
 	unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader);
-	ShaderProgramSource ParseShader(const std::string& filepath);
+	void Start(const ShaderProgramSource& source);
+	void Discard(); //Drops the build in flight
+	void Swap(unsigned int program);
+	void CopyUniforms(unsigned int from, const std::vector<Uniform>& uniforms) const; //Into m_RendererID, where both have them
 };
\ No newline at end of file
@@ -0,0 +1,126 @@
+#include "ShaderHotReload.h"
+#include "Profiler.h"
+#include <algorithm>
+
+ShaderHotReload::ShaderHotReload()
+{
+}
+
+ShaderHotReload::~ShaderHotReload()
+{
+    //The watcher thread calls into this object, it has to stop first
+    m_Watcher.reset();
+}
+
+ShaderHotReload& ShaderHotReload::Get()
+{
+    static ShaderHotReload reload;
+    return reload;
+}
+
+void ShaderHotReload::Watch(Shader& shader)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (shader.m_HotReload)
+        return;
+    if (!m_Watcher)
+        m_Watcher.reset(new FileWatcher([this](const std::string& path) { OnFileChanged(path); }));
+    shader.m_HotReload = true;
+    m_Shaders[shader.GetFilePath()].push_back(&shader);
+    m_Watcher->Watch(shader.GetFilePath());
+}
+
+void ShaderHotReload::Unwatch(Shader& shader)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (!shader.m_HotReload)
+        return;
+    shader.m_HotReload = false;
+    auto it = m_Shaders.find(shader.GetFilePath());
+    if (it == m_Shaders.end())
+        return;
+    std::vector<Shader*>& shaders = it->second;
+    shaders.erase(std::remove(shaders.begin(), shaders.end(), &shader), shaders.end());
+    if (shaders.empty())
+        m_Shaders.erase(it);
+    m_Watcher->Unwatch(shader.GetFilePath());
+}
+
+void ShaderHotReload::Exchange(Shader& a, Shader& b)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for (auto& file : m_Shaders)
+    {
+        for (Shader*& shader : file.second)
+        {
+            if (shader == &a)
+                shader = &b;
+            else if (shader == &b)
+                shader = &a;
+        }
+    }
+}
+
+void ShaderHotReload::Update()
+{
+    PROFILE_SCOPE("ShaderHotReload::Update");
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for (auto& change : m_Changes)
+    {
+        auto shaders = m_Shaders.find(change.first);
+        if (shaders == m_Shaders.end())
+            continue;
+        std::cout << "[ShaderHotReload] Reloading " << change.first << std::endl;
+        for (Shader* shader : shaders->second)
+        {
+            unsigned int program = shader->GetRendererID();
+            shader->Reload(change.second.Source);
+            if (shader->GetRendererID() != program) //Found in the ProgramCache
+                m_Stats.Swaps++;
+        }
+        m_Building[change.first] = change.second.Seen;
+        m_Stats.Reloads++;
+    }
+    m_Changes.clear();
+
+    //Only programs still building are polled, the others were swapped (or kept) inside Reload
+    for (auto building = m_Building.begin(); building != m_Building.end();)
+    {
+        bool done = true;
+        auto shaders = m_Shaders.find(building->first);
+        if (shaders != m_Shaders.end())
+        {
+            for (Shader* shader : shaders->second)
+            {
+                unsigned int program = shader->GetRendererID();
+                done = shader->Poll() && done;
+                if (shader->GetRendererID() != program)
+                    m_Stats.Swaps++;
+            }
+        }
+        if (!done)
+        {
+            ++building;
+            continue;
+        }
+        std::chrono::duration<double, std::milli> latency = std::chrono::high_resolution_clock::now() - building->second;
+        m_Stats.LastLatencyMs = latency.count();
+        building = m_Building.erase(building);
+    }
+}
+
+ShaderHotReload::Stats ShaderHotReload::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Stats;
+}
+
+void ShaderHotReload::OnFileChanged(const std::string& path)
+{
+    //Parsed here, off the render thread. A save in several writes parses again, the last one wins
+    Change change;
+    change.Source = Shader::ParseShader(path);
+    change.Seen = std::chrono::high_resolution_clock::now();
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Changes[path] = change;
+}
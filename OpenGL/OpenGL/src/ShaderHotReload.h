@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include "Shader.h"
+#include "FileWatcher.h"
+
+//Rebuilds watched shaders when their file is saved. The FileWatcher thread sees the write and parses the file right
+//there; Update, once per frame on the thread that owns the context, hands the new sources to every Shader built from
+//that file and finishes their builds as the driver gets them done. Each Shader keeps drawing with its running program
+//until the new one links (Shader::Reload), so the scene never waits for the compiler where parallel compile exists.
+//A Shader unregisters itself when it goes away, and moving one moves the registration.
+class ShaderHotReload
+{
+public:
+	struct Stats
+	{
+		unsigned int Reloads = 0; //Saves that were picked up
+		unsigned int Swaps = 0; //Programs replaced
+		double LastLatencyMs = 0.0; //From the watcher seeing the save to the last swap for it
+	};
+private:
+	struct Change
+	{
+		ShaderProgramSource Source;
+		std::chrono::high_resolution_clock::time_point Seen;
+	};
+
+	mutable std::mutex m_Mutex;
+	std::unordered_map<std::string, std::vector<Shader*>> m_Shaders; //By file path
+	std::unordered_map<std::string, Change> m_Changes; //Parsed on the watcher thread, waiting for Update
+	std::unordered_map<std::string, std::chrono::high_resolution_clock::time_point> m_Building; //Saves being built
+	std::unique_ptr<FileWatcher> m_Watcher; //Started by the first Watch
+	Stats m_Stats;
+
+	ShaderHotReload();
+public:
+	~ShaderHotReload();
+
+	static ShaderHotReload& Get();
+
+	void Watch(Shader& shader);
+	void Unwatch(Shader& shader);
+	void Exchange(Shader& a, Shader& b); //After a move: a's registration is b's and b's is a's
+
+	void Update();
+
+	Stats GetStats() const;
+private:
+	void OnFileChanged(const std::string& path); //Watcher thread
+};
@@ -0,0 +1,183 @@
+#include "ShaderLibrary.h"
+#include "Profiler.h"
+#include <fstream>
+#include <sstream>
+#include <chrono>
+
+ShaderLibrary::ShaderLibrary(const std::string& placeholderPath)
+    :m_Placeholder(new Shader(placeholderPath)), m_Parallel(false), m_FrameBudgetMs(2.0), m_Pending(0)
+{
+    SetParallelEnabled(true);
+}
+
+bool ShaderLibrary::LoadManifest(const std::string& path)
+{
+    std::ifstream stream(path);
+    if (!stream)
+    {
+        std::cout << "[ShaderLibrary] Could not read " << path << std::endl;
+        return false;
+    }
+
+    std::string line;
+    while (getline(stream, line))
+    {
+        line = line.substr(0, line.find('#'));
+        std::stringstream words(line);
+        std::string name, program;
+        if (!(words >> name))
+            continue;
+        if (!(words >> program))
+        {
+            std::cout << "[ShaderLibrary] No path for " << name << " in " << path << std::endl;
+            continue;
+        }
+        Add(name, program);
+    }
+    return true;
+}
+
+void ShaderLibrary::Add(const std::string& name, const std::string& path)
+{
+    auto it = m_Index.find(name);
+    if (it == m_Index.end())
+    {
+        it = m_Index.insert({ name, (unsigned int)m_Entries.size() }).first;
+        m_Entries.push_back({ name, path, nullptr, false, false, false, 0 });
+    }
+
+    Entry& entry = m_Entries[it->second];
+    if (!entry.Pending)
+        m_Pending++;
+    entry.Path = path;
+    entry.Started = false; //A build still running is out of date, Start replaces it
+    entry.Pending = true;
+    if (m_Parallel)
+        Start(entry);
+}
+
+void ShaderLibrary::Update()
+{
+    PROFILE_SCOPE("ShaderLibrary::Update");
+    auto start = std::chrono::high_resolution_clock::now();
+    bool budgetSpent = false;
+    for (Entry& entry : m_Entries)
+    {
+        if (m_Pending == 0)
+            break;
+        if (!entry.Pending)
+            continue;
+
+        if (entry.Started)
+        {
+            if (entry.Program->Poll())
+                Finish(entry);
+            continue;
+        }
+        //Built here and now, one after the other until the frame had its share
+        if (budgetSpent)
+            continue;
+        Start(entry);
+        entry.Program->Poll(true);
+        Finish(entry);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+        budgetSpent = elapsed.count() >= m_FrameBudgetMs;
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+    m_Stats.UpdateMs = elapsed.count();
+}
+
+void ShaderLibrary::WaitAll()
+{
+    for (Entry& entry : m_Entries)
+    {
+        if (!entry.Pending)
+            continue;
+        if (!entry.Started)
+            Start(entry);
+        entry.Program->Poll(true);
+        Finish(entry);
+    }
+}
+
+Shader& ShaderLibrary::Get(const std::string& name)
+{
+    auto it = m_Index.find(name);
+    if (it == m_Index.end())
+    {
+        std::cout << "[ShaderLibrary] No program named " << name << std::endl;
+        return *m_Placeholder;
+    }
+    const Entry& entry = m_Entries[it->second];
+    return entry.Ready ? *entry.Program : *m_Placeholder;
+}
+
+bool ShaderLibrary::IsReady(const std::string& name) const
+{
+    auto it = m_Index.find(name);
+    if (it == m_Index.end())
+        return false;
+    const Entry& entry = m_Entries[it->second];
+    return entry.Ready;
+}
+
+void ShaderLibrary::SetParallelEnabled(bool enabled)
+{
+    m_Parallel = enabled && Shader::IsParallelCompileSupported();
+    if (m_Parallel)
+    {
+        //Let the driver pick how many threads to compile on
+        if (GLEW_KHR_parallel_shader_compile)
+        {
+            GLCall(glMaxShaderCompilerThreadsKHR(0xffffffff));
+        }
+        else
+        {
+            GLCall(glMaxShaderCompilerThreadsARB(0xffffffff));
+        }
+    }
+}
+
+ShaderLibrary::Stats ShaderLibrary::GetStats() const
+{
+    Stats stats = m_Stats;
+    stats.Programs = (unsigned int)m_Entries.size();
+    stats.Pending = m_Pending;
+    for (const Entry& entry : m_Entries)
+    {
+        if (!entry.Ready && !entry.Pending)
+            stats.Failed++;
+    }
+    return stats;
+}
+
+void ShaderLibrary::Start(Entry& entry)
+{
+    entry.Started = true;
+    if (entry.Ready)
+    {
+        //In place, so what Get handed out stays valid and keeps its uniform values
+        entry.Previous = entry.Program->GetRendererID();
+        entry.Program->Reload(Shader::ParseShader(entry.Path));
+        return;
+    }
+    entry.Program.reset(new Shader(entry.Path, false));
+}
+
+void ShaderLibrary::Finish(Entry& entry)
+{
+    entry.Pending = false;
+    entry.Started = false;
+    m_Pending--;
+    if (!entry.Ready)
+    {
+        entry.Ready = entry.Program->IsReady();
+        if (!entry.Ready)
+        {
+            std::cout << "[ShaderLibrary] " << entry.Name << " failed to build, keeps the placeholder" << std::endl;
+            entry.Program.reset();
+        }
+    }
+    else if (entry.Program->GetRendererID() == entry.Previous)
+        std::cout << "[ShaderLibrary] " << entry.Name << " failed to build, keeps the last program that did" << std::endl;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include "Shader.h"
+
+//Programs by name, built without stopping the frame loop. Add (or a manifest) starts every compile and link at once
+//and returns, Update picks up the programs that are done, once per frame. With KHR_parallel_shader_compile the driver
+//builds them on its own threads and Update only asks GL_COMPLETION_STATUS_KHR. Without it a build blocks whoever
+//waits for it, so Update builds the programs one after the other until the frame's budget is spent.
+//Get hands out the placeholder until a program is ready (or for good if it failed), so drawing carries on meanwhile.
+//A program added again is rebuilt in place (Shader::Reload): the Shader Get returned stays the same object, keeps
+//drawing with its running program until the rebuild is ready, keeps it if the rebuild fails, and keeps its uniform values.
+class ShaderLibrary
+{
+public:
+	struct Stats
+	{
+		unsigned int Programs = 0;
+		unsigned int Pending = 0;
+		unsigned int Failed = 0;
+		double UpdateMs = 0.0; //Last Update
+	};
+private:
+	struct Entry
+	{
+		std::string Name;
+		std::string Path;
+		std::unique_ptr<Shader> Program; //Null until the first build starts, and again if it fails
+		bool Ready; //Program linked at least once, Get hands it out
+		bool Started; //The pending build is under way
+		bool Pending; //Added and not done yet
+		unsigned int Previous; //Program's GL program when its rebuild started, unchanged after Poll if the rebuild failed
+	};
+
+	std::vector<Entry> m_Entries;
+	std::unordered_map<std::string, unsigned int> m_Index; //Name to position in m_Entries
+	std::unique_ptr<Shader> m_Placeholder;
+	bool m_Parallel;
+	double m_FrameBudgetMs;
+	unsigned int m_Pending; //Added but not done
+	Stats m_Stats;
+public:
+	//The placeholder is built right away. It should draw with the attributes and uniforms the real programs use
+	ShaderLibrary(const std::string& placeholderPath = "resources/shaders/Placeholder.shader");
+
+	//One program per line: name and path, separated by spaces. # starts a comment. Returns false if it can't be read
+	bool LoadManifest(const std::string& path);
+	//Same name again rebuilds it, from path. The Shader keeps the path it was first built from, for hot reload and messages
+	void Add(const std::string& name, const std::string& path);
+
+	void Update(); //Once per frame, on the thread that owns the context
+	void WaitAll(); //Loading screens and tools: blocks until every program is done
+
+	//The program if ready, the placeholder otherwise. A reference to a ready program stays valid as long as the library,
+	//rebuilds included; one to the placeholder only stands for the program until the program is ready.
+	Shader& Get(const std::string& name);
+	bool IsReady(const std::string& name) const; //Get gives a real program, maybe the last one while a rebuild runs
+	inline bool IsLoading() const { return m_Pending != 0; }
+
+	//Without parallel compile: milliseconds of building per Update, at least one program always goes through
+	inline void SetFrameBudget(double ms) { m_FrameBudgetMs = ms; }
+	//Off builds the programs over frames even where the driver could do it in parallel, for comparison.
+	//Only affects programs added later.
+	void SetParallelEnabled(bool enabled);
+	inline bool IsParallelEnabled() const { return m_Parallel; }
+
+	Stats GetStats() const;
+private:
+	void Start(Entry& entry);
+	void Finish(Entry& entry);
+};
@@ -0,0 +1,186 @@
+#include "StreamBuffer.h"
+#include "Renderer.h"
+#include "GLStateCache.h"
+#include "DeletionQueue.h"
+#include "GpuMemory.h"
+#include <iostream>
+
+StreamBuffer::StreamBuffer(unsigned int target, unsigned int size)
+    :m_RendererID(0), m_Target(target), m_Size(size), m_MinAlignment(1), m_Persistent(IsPersistentMappingSupported()),
+    m_Mapped(nullptr), m_Head(0), m_InUse(0), m_FrameBytes(0)
+{
+    if (target == GL_UNIFORM_BUFFER)
+    {
+        GLint alignment;
+        GLCall(glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment));
+        m_MinAlignment = alignment;
+    }
+
+    GLCall(glGenBuffers(1, &m_RendererID));
+    GpuMemory::Get().Allocate(GpuMemory::Category::StreamBuffer, m_RendererID, size, "", false); //Can't run without it, never refused
+    Bind();
+    if (m_Persistent)
+    {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        GLCall(glBufferStorage(m_Target, size, nullptr, flags));
+        GLCall(m_Mapped = (char*)glMapBufferRange(m_Target, 0, size, flags));
+    }
+    else
+    {
+        GLCall(glBufferData(m_Target, size, nullptr, GL_STREAM_DRAW));
+    }
+}
+
+StreamBuffer::~StreamBuffer()
+{
+    for (FrameFence& frame : m_Fences)
+    {
+        GLCall(glDeleteSync((GLsync)frame.Fence));
+    }
+    if (m_Mapped)
+    {
+        Bind();
+        GLCall(glUnmapBuffer(m_Target));
+    }
+    DeletionQueue::Get().Enqueue(DeletionQueue::Type::Buffer, m_RendererID, m_Size);
+}
+
+bool StreamBuffer::IsPersistentMappingSupported()
+{
+    return GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+}
+
+StreamBuffer::Allocation StreamBuffer::Allocate(unsigned int size, unsigned int alignment)
+{
+    if (alignment < m_MinAlignment)
+        alignment = m_MinAlignment;
+    if (size > m_Size)
+    {
+        std::cout << "[StreamBuffer] Allocation of " << size << " bytes does not fit a buffer of " << m_Size << std::endl;
+        return { nullptr, 0, 0 };
+    }
+
+    Commit();
+
+    unsigned int offset = (m_Head + alignment - 1) / alignment * alignment;
+    bool wraps = offset + size > m_Size;
+    if (wraps)
+        offset = 0;
+    //What the ring loses to this allocation: alignment padding, or the rest of the buffer when it wraps
+    unsigned int needed = (wraps ? m_Size - m_Head : offset - m_Head) + size;
+
+    if (m_Persistent)
+    {
+        //Free the oldest frames until there is room, waiting only on those the GPU isn't done with
+        while (m_InUse + needed > m_Size)
+        {
+            if (m_Fences.empty())
+            {
+                if (m_FrameBytes == 0)
+                    break; //Nothing in flight, the whole buffer is free
+                //The frame alone outgrew the buffer: fence what it wrote so far and wait until the GPU has read it
+                FenceFrame();
+                m_Stats.FrameSplits++;
+            }
+            RetireOldestFrame(true);
+        }
+    }
+    else
+    {
+        if (wraps)
+        {
+            //Orphan: the driver hands out fresh storage while the GPU keeps reading the old one
+            Bind();
+            GLCall(glBufferData(m_Target, m_Size, nullptr, GL_STREAM_DRAW));
+            m_Stats.Orphans++;
+            needed = size;
+        }
+        Bind();
+        GLCall(m_Mapped = (char*)glMapBufferRange(m_Target, offset, size, GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT));
+    }
+
+    m_Head = offset + size;
+    m_InUse += needed;
+    m_FrameBytes += needed;
+    GLStateCache::Get().OnUpload(size);
+    return { m_Persistent ? m_Mapped + offset : m_Mapped, offset, size };
+}
+
+void StreamBuffer::Commit()
+{
+    if (m_Persistent || !m_Mapped)
+        return;
+    Bind();
+    GLCall(glUnmapBuffer(m_Target));
+    m_Mapped = nullptr;
+}
+
+void StreamBuffer::EndFrame()
+{
+    Commit();
+    if (!m_Persistent)
+    {
+        //Orphaning does the synchronization, only the ring position carries over
+        m_InUse = 0;
+        m_FrameBytes = 0;
+        return;
+    }
+    if (m_FrameBytes == 0)
+        return;
+
+    FenceFrame();
+
+    //Most frames are done by the time the ring comes around, free them now so Allocate rarely waits
+    while (!m_Fences.empty())
+    {
+        GLCall(GLenum status = glClientWaitSync((GLsync)m_Fences.front().Fence, 0, 0));
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            break;
+        RetireOldestFrame(false);
+    }
+}
+
+void StreamBuffer::FenceFrame()
+{
+    GLCall(GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+    m_Fences.push_back({ fence, m_FrameBytes });
+    m_FrameBytes = 0;
+}
+
+void StreamBuffer::RetireOldestFrame(bool wait)
+{
+    FrameFence frame = m_Fences.front();
+    m_Fences.pop_front();
+    if (wait)
+    {
+        GLCall(GLenum status = glClientWaitSync((GLsync)frame.Fence, 0, 0));
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+        {
+            m_Stats.FenceWaits++;
+            //Flush so the fence can signal at all, then wait for real
+            while (true)
+            {
+                GLCall(status = glClientWaitSync((GLsync)frame.Fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000));
+                if (status != GL_TIMEOUT_EXPIRED)
+                    break;
+            }
+        }
+    }
+    GLCall(glDeleteSync((GLsync)frame.Fence));
+    m_InUse -= frame.Bytes;
+}
+
+void StreamBuffer::Bind() const
+{
+    GLStateCache::Get().BindBuffer(m_Target, m_RendererID);
+}
+
+void StreamBuffer::BindRange(unsigned int index, const Allocation& allocation) const
+{
+    if (m_Target == GL_UNIFORM_BUFFER)
+        GLStateCache::Get().BindUniformBuffer(index, m_RendererID, allocation.Offset, allocation.Size);
+    else
+    {
+        GLCall(glBindBufferRange(m_Target, index, m_RendererID, allocation.Offset, allocation.Size));
+    }
+}
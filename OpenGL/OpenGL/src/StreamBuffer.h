@@ -0,0 +1,74 @@
+#pragma once
+
+#include <deque>
+
+//One large buffer object used as a ring for data written every frame (dynamic vertices, per-object constants).
+//With GL 4.4 / ARB_buffer_storage the buffer stays mapped persistently and coherently, Allocate hands out
+//pointers straight into it and fences keep the CPU from overwriting what the GPU still reads.
+//Without it each allocation maps its range unsynchronized, and the buffer is orphaned when the ring wraps.
+//
+//Per frame: Allocate and write, Commit before the draws that read the data, EndFrame after them.
+//The pointer from Allocate is only valid until the next Allocate or Commit.
+//A frame that needs more than the whole buffer doesn't fail: Allocate fences what the frame wrote so far and waits
+//for the GPU to finish with it before wrapping. That is only safe if the draws reading those earlier allocations have
+//been issued, as when each allocation is drawn before the next one is made (BatchRenderer2D).
+class StreamBuffer
+{
+public:
+	struct Allocation
+	{
+		void* Data; //nullptr if the request is larger than the buffer
+		unsigned int Offset; //In bytes from the start of the buffer, for attribute offsets or glBindBufferRange
+		unsigned int Size;
+	};
+
+	struct Stats
+	{
+		unsigned int FenceWaits = 0; //Allocations that had to wait for the GPU
+		unsigned int Orphans = 0; //Fallback path only
+		unsigned int FrameSplits = 0; //Frames larger than the buffer, fenced part way through so the ring could wrap
+	};
+private:
+	struct FrameFence
+	{
+		void* Fence; //GLsync
+		unsigned int Bytes; //Ring space the frame used, padding included
+	};
+
+	unsigned int m_RendererID;
+	unsigned int m_Target;
+	unsigned int m_Size;
+	unsigned int m_MinAlignment;
+	bool m_Persistent;
+	char* m_Mapped; //Whole buffer when persistent, the last allocation otherwise
+
+	unsigned int m_Head;
+	unsigned int m_InUse; //Bytes between the oldest unfinished frame and the head
+	unsigned int m_FrameBytes;
+	std::deque<FrameFence> m_Fences;
+	Stats m_Stats;
+public:
+	//target: GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER or GL_UNIFORM_BUFFER. Size it for about three frames.
+	StreamBuffer(unsigned int target, unsigned int size);
+	~StreamBuffer();
+
+	//alignment doesn't have to be a power of two, vertex data is aligned to the vertex size so it can be
+	//drawn with baseVertex. Uniform buffers are aligned to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT at least.
+	Allocation Allocate(unsigned int size, unsigned int alignment = 4);
+	void Commit(); //Unmaps the last allocation on the fallback path, nothing to do when persistent
+	void EndFrame(); //Fences the data allocated since the last EndFrame
+
+	void Bind() const;
+	void BindRange(unsigned int index, const Allocation& allocation) const; //GL_UNIFORM_BUFFER binding points
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline unsigned int GetSize() const { return m_Size; }
+	inline unsigned int GetMinAlignment() const { return m_MinAlignment; }
+	inline bool IsPersistent() const { return m_Persistent; }
+	inline const Stats& GetStats() const { return m_Stats; }
+
+	static bool IsPersistentMappingSupported();
+private:
+	void FenceFrame(); //The bytes allocated since the last fence
+	void RetireOldestFrame(bool wait);
+};
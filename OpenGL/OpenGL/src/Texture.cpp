@@ -1,38 +1,117 @@
 #include "Texture.h"
+#include "GLStateCache.h"
+#include "Profiler.h"
+#include "DeletionQueue.h"
+#include "GpuMemory.h"
 #include "stb_image/stb_image.h"
+#include <utility>
 
 Texture::Texture(const std::string& path) 
 	:m_RendererID(0),m_FilePath(path), m_LocalBuffer(nullptr), m_Width(0), m_Height(0), m_BPP(0)
 {
 	stbi_set_flip_vertically_on_load(1);
-	m_LocalBuffer = stbi_load(path.c_str(),&m_Width,&m_Height,&m_BPP,4);
+	//Grey and grey+alpha images keep their channel count, RGB is padded to RGBA since drivers store RGB8 as 4 bytes anyway
+	int channels = 4;
+	if (stbi_info(path.c_str(), &m_Width, &m_Height, &channels) && channels <= 2)
+		m_BPP = channels;
+	else
+		m_BPP = 4;
+	m_LocalBuffer = stbi_load(path.c_str(),&m_Width,&m_Height,&channels,m_BPP);
 
-	GLCall(glGenTextures(1,&m_RendererID));
-	GLCall(glBindTexture(GL_TEXTURE_2D,m_RendererID));
+	Create(m_LocalBuffer);
+
+	if (m_LocalBuffer)
+		stbi_image_free(m_LocalBuffer);
+}
+
+Texture::Texture(int width, int height, const void* data)
+	:m_RendererID(0), m_FilePath(), m_LocalBuffer(nullptr), m_Width(width), m_Height(height), m_BPP(4)
+{
+	Create(data);
+}
+
+Texture::~Texture() 
+{
+	DeletionQueue::Get().Enqueue(DeletionQueue::Type::Texture, m_RendererID, (unsigned long long)m_Width * m_Height * m_BPP);
+}
+
+void Texture::Create(const void* data)
+{
+	GLCall(glGenTextures(1, &m_RendererID));
+	GLStateCache::Get().BindTexture(0, m_RendererID);
 
 	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
 	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
 	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
 	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
 
-	GLCall(glTexImage2D(GL_TEXTURE_2D,0,GL_RGBA8,m_Width,m_Height,0,GL_RGBA,GL_UNSIGNED_BYTE,m_LocalBuffer));
-	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+	static const unsigned int s_Placeholder = 0xffff00ff; //Magenta, so a refused texture stands out
+	if (!GpuMemory::Get().Allocate(GpuMemory::Category::Texture, m_RendererID, (unsigned long long)m_Width * m_Height * m_BPP, m_FilePath))
+	{
+		m_Width = m_Height = 1;
+		m_BPP = 4;
+		data = &s_Placeholder;
+		GpuMemory::Get().Allocate(GpuMemory::Category::Texture, m_RendererID, 4, m_FilePath, false);
+	}
 
-	if (m_LocalBuffer)
-		stbi_image_free(m_LocalBuffer);
+	//Shaders sample every format as RGBA: grey goes to all three colour channels, the second channel to alpha
+	GLenum internalFormat = GL_RGBA8, format = GL_RGBA;
+	if (m_BPP == 1)
+	{
+		internalFormat = GL_R8;
+		format = GL_RED;
+		GLint swizzle[] = { GL_RED, GL_RED, GL_RED, GL_ONE };
+		GLCall(glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle));
+	}
+	else if (m_BPP == 2)
+	{
+		internalFormat = GL_RG8;
+		format = GL_RG;
+		GLint swizzle[] = { GL_RED, GL_RED, GL_RED, GL_GREEN };
+		GLCall(glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle));
+	}
+
+	//Rows of 1 and 2 byte texels aren't 4-byte aligned in general
+	if (m_BPP != 4) {
+		GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+	}
+	GLCall(glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, m_Width, m_Height, 0, format, GL_UNSIGNED_BYTE, data));
+	if (m_BPP != 4) {
+		GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+	}
+	GLStateCache::Get().OnUpload((unsigned long long)m_Width * m_Height * m_BPP);
+	GLStateCache::Get().BindTexture(0, 0);
 }
 
-Texture::~Texture() 
+void Texture::SetLabel(const std::string& label)
+{
+	GpuMemory::Get().SetLabel(GpuMemory::Category::Texture, m_RendererID, label);
+}
+
+Texture::Texture(Texture&& other) noexcept
+	:m_RendererID(other.m_RendererID), m_FilePath(std::move(other.m_FilePath)), m_LocalBuffer(nullptr),
+	m_Width(other.m_Width), m_Height(other.m_Height), m_BPP(other.m_BPP)
+{
+	other.m_RendererID = 0;
+}
+
+Texture& Texture::operator=(Texture&& other) noexcept
 {
-	GLCall(glDeleteTextures(1, &m_RendererID));
+	//Swapped, other's destructor deletes the texture this one held
+	std::swap(m_RendererID, other.m_RendererID);
+	std::swap(m_FilePath, other.m_FilePath);
+	std::swap(m_Width, other.m_Width);
+	std::swap(m_Height, other.m_Height);
+	std::swap(m_BPP, other.m_BPP);
+	return *this;
 }
 
 void Texture::Bind(unsigned int slot) const
 {
-	GLCall(glActiveTexture(GL_TEXTURE0 + slot));
-	GLCall(glBindTexture(GL_TEXTURE_2D,m_RendererID));
+	PROFILE_SCOPE("Texture::Bind");
+	GLStateCache::Get().BindTexture(slot, m_RendererID);
 }
-void Texture::Unbind() const  
+void Texture::Unbind(unsigned int slot) const
 {
-	GLCall(glBindTexture(GL_TEXTURE_2D,0));
+	GLStateCache::Get().BindTexture(slot, 0);
 }
@@ -8,14 +8,27 @@ private:
 	unsigned int m_RendererID;
 	std::string m_FilePath;
 	unsigned char* m_LocalBuffer;
-	int m_Width, m_Height, m_BPP;
+	int m_Width, m_Height, m_BPP; //m_BPP: bytes per texel on the GPU, 1 (grey), 2 (grey and alpha) or 4
 public:
+	//Accounted in GpuMemory under the file path. Over budget it becomes a 1x1 magenta texture.
 	Texture(const std::string& path);
+	Texture(int width, int height, const void* data); //Raw RGBA8 pixels
 	~Texture();
 
+	//Owns the GL texture: move-only, a moved-from Texture is empty
+	Texture(const Texture&) = delete;
+	Texture& operator=(const Texture&) = delete;
+	Texture(Texture&& other) noexcept;
+	Texture& operator=(Texture&& other) noexcept;
+
+	void SetLabel(const std::string& label); //Name it is accounted under in GpuMemory
+
 	void Bind(unsigned int slot = 0) const;
-	void Unbind() const;
+	void Unbind(unsigned int slot = 0) const;
 
 	inline int GetWidth() const { return m_Width; }
 	inline int GetHeight() const { return m_Height; }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+private:
+	void Create(const void* data); //Texture object and storage for m_Width x m_Height texels of m_BPP bytes
 };
\ No newline at end of file
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include "glm/glm.hpp"
+
+//Compile-time uniform block layouts, the uniform counterpart of VertexFormat.h. Declare the members of a block
+//struct once, at namespace scope after the struct, with the GLSL name of the block and its binding point:
+//
+//	struct LightUniforms { glm::vec3 Direction; float Intensity; glm::mat3 Rotation; float Weights[3]; };
+//	UNIFORM_BLOCK(LightUniforms, "Light", 2,
+//		UNIFORM_MEMBER(LightUniforms, Direction),
+//		UNIFORM_MEMBER(LightUniforms, Intensity),
+//		UNIFORM_MEMBER(LightUniforms, Rotation),
+//		UNIFORM_MEMBER(LightUniforms, Weights))
+//
+//matching, member for member and in order, the shader's
+//
+//	layout(std140) uniform Light { vec3 u_Direction; float u_Intensity; mat3 u_Rotation; float u_Weights[3]; };
+//
+//UniformBlockLayout works out where std140 (or std430) puts each member. Where that is where the C++ struct has it
+//already, as for LightUniforms' first two members, writing the block is a memcpy; otherwise, as for the mat3 columns
+//and the array elements std140 pads to 16 bytes, the members are copied to their place one vector at a time.
+//Members are float/int/uint scalars, glm vectors and float matrices, and arrays of them. bool and nested structs are not.
+
+enum class UniformPacking { Std140, Std430 };
+
+struct UniformMember
+{
+	unsigned int offset; //offsetof the member
+	unsigned int memberSize; //sizeof the member
+	unsigned int components; //Of one vector, 4 bytes each
+	unsigned int vectors; //Matrix columns times array length, 1 for a plain scalar or vector
+	bool array; //An array or a matrix, laid out as strided vectors
+
+	static constexpr unsigned int RoundUp(unsigned int value, unsigned int alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	constexpr unsigned int GetVectorSize() const { return components * 4; }
+	constexpr unsigned int GetSourceStride() const { return memberSize / vectors; }
+	//std140 rounds what arrays and matrices are made of up to a vec4, std430 doesn't. vec3 aligns like a vec4 in both
+	constexpr unsigned int GetAlignment(UniformPacking packing) const
+	{
+		return array && packing == UniformPacking::Std140 ? 16 : components == 3 ? 16 : components * 4;
+	}
+	constexpr unsigned int GetStride(UniformPacking packing) const { return RoundUp(GetVectorSize(), GetAlignment(packing)); }
+	constexpr unsigned int GetSize(UniformPacking packing) const { return array ? vectors * GetStride(packing) : GetVectorSize(); }
+};
+
+template<unsigned int Components, unsigned int Columns = 1>
+struct UniformMemberFormat
+{
+	//length 0: not an array
+	static constexpr UniformMember At(unsigned int offset, unsigned int memberSize, unsigned int length = 0)
+	{
+		return { offset, memberSize, Components, Columns * (length ? length : 1), Columns > 1 || length > 0 };
+	}
+};
+
+template<typename T> struct UniformMemberTraits;
+template<> struct UniformMemberTraits<float> : UniformMemberFormat<1> {};
+template<> struct UniformMemberTraits<glm::vec2> : UniformMemberFormat<2> {};
+template<> struct UniformMemberTraits<glm::vec3> : UniformMemberFormat<3> {};
+template<> struct UniformMemberTraits<glm::vec4> : UniformMemberFormat<4> {};
+template<> struct UniformMemberTraits<int> : UniformMemberFormat<1> {};
+template<> struct UniformMemberTraits<glm::ivec2> : UniformMemberFormat<2> {};
+template<> struct UniformMemberTraits<glm::ivec3> : UniformMemberFormat<3> {};
+template<> struct UniformMemberTraits<glm::ivec4> : UniformMemberFormat<4> {};
+template<> struct UniformMemberTraits<unsigned int> : UniformMemberFormat<1> {};
+template<> struct UniformMemberTraits<glm::uvec2> : UniformMemberFormat<2> {};
+template<> struct UniformMemberTraits<glm::uvec3> : UniformMemberFormat<3> {};
+template<> struct UniformMemberTraits<glm::uvec4> : UniformMemberFormat<4> {};
+//Column-major, a column is a vector
+template<> struct UniformMemberTraits<glm::mat2> : UniformMemberFormat<2, 2> {};
+template<> struct UniformMemberTraits<glm::mat3> : UniformMemberFormat<3, 3> {};
+template<> struct UniformMemberTraits<glm::mat4> : UniformMemberFormat<4, 4> {};
+template<typename T, size_t Length>
+struct UniformMemberTraits<T[Length]>
+{
+	static constexpr UniformMember At(unsigned int offset, unsigned int memberSize)
+	{
+		return UniformMemberTraits<T>::At(offset, memberSize, (unsigned int)Length);
+	}
+};
+
+//Specialized by UNIFORM_BLOCK: GetName() of the GLSL block, Binding, Count, and Get(i) for the i-th member in declaration order
+template<typename Block> struct UniformBlock;
+
+template<typename... Members>
+constexpr unsigned int CountUniformMembers(const Members&...) { return sizeof...(Members); }
+
+template<typename Block, UniformPacking Packing = UniformPacking::Std140>
+struct UniformBlockLayout
+{
+	static constexpr unsigned int Count = UniformBlock<Block>::Count;
+
+	//Where member i goes in the buffer. Offset(Count) is where the last member ends
+	static constexpr unsigned int Offset(unsigned int i)
+	{
+		unsigned int offset = 0;
+		for (unsigned int j = 0; j < i; j++)
+		{
+			UniformMember member = UniformBlock<Block>::Get(j);
+			offset = UniformMember::RoundUp(offset, member.GetAlignment(Packing)) + member.GetSize(Packing);
+		}
+		return i < Count ? UniformMember::RoundUp(offset, UniformBlock<Block>::Get(i).GetAlignment(Packing)) : offset;
+	}
+
+	//What a buffer range for the block needs, GL_UNIFORM_BLOCK_DATA_SIZE. std140 rounds a block up to a vec4
+	static constexpr unsigned int Size()
+	{
+		unsigned int alignment = Packing == UniformPacking::Std140 ? 16 : 4;
+		for (unsigned int i = 0; i < Count; i++)
+		{
+			if (UniformBlock<Block>::Get(i).GetAlignment(Packing) > alignment)
+				alignment = UniformBlock<Block>::Get(i).GetAlignment(Packing);
+		}
+		return UniformMember::RoundUp(Offset(Count), alignment);
+	}
+
+	static constexpr bool SizesMatch()
+	{
+		for (unsigned int i = 0; i < Count; i++)
+		{
+			UniformMember member = UniformBlock<Block>::Get(i);
+			if (member.memberSize != member.vectors * member.GetVectorSize())
+				return false;
+		}
+		return true;
+	}
+
+	//True when the struct already is the block's layout, every member and every array element in place
+	static constexpr bool MatchesStruct()
+	{
+		for (unsigned int i = 0; i < Count; i++)
+		{
+			UniformMember member = UniformBlock<Block>::Get(i);
+			if (Offset(i) != member.offset || (member.array && member.GetStride(Packing) != member.GetSourceStride()))
+				return false;
+		}
+		return sizeof(Block) <= Size();
+	}
+
+	//destination has Size() bytes. Padding between members is left as it is
+	static void Write(const Block& block, void* destination)
+	{
+		if (MatchesStruct())
+		{
+			memcpy(destination, &block, sizeof(Block));
+			return;
+		}
+		const char* source = (const char*)&block;
+		char* target = (char*)destination;
+		for (unsigned int i = 0; i < Count; i++)
+		{
+			UniformMember member = UniformBlock<Block>::Get(i);
+			unsigned int offset = Offset(i);
+			unsigned int stride = member.GetStride(Packing);
+			unsigned int sourceStride = member.GetSourceStride();
+			for (unsigned int v = 0; v < member.vectors; v++)
+				memcpy(target + offset + v * stride, source + member.offset + v * sourceStride, member.GetVectorSize());
+		}
+	}
+};
+
+#define UNIFORM_MEMBER(Block, member) \
+	UniformMemberTraits<decltype(Block::member)>::At((unsigned int)offsetof(Block, member), (unsigned int)sizeof(Block::member))
+
+#define UNIFORM_BLOCK(Block, name, binding, ...) \
+	template<> struct UniformBlock<Block> \
+	{ \
+		static constexpr unsigned int Binding = binding; \
+		static constexpr unsigned int Count = CountUniformMembers(__VA_ARGS__); \
+		static const char* GetName() { return name; } \
+		static constexpr UniformMember Get(unsigned int i) \
+		{ \
+			const UniformMember members[] = { __VA_ARGS__ }; \
+			return members[i]; \
+		} \
+	}; \
+	static_assert(UniformBlockLayout<Block>::SizesMatch(), #Block ": a member's size doesn't match its type");
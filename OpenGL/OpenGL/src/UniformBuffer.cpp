@@ -0,0 +1,71 @@
+#include "UniformBuffer.h"
+#include "Renderer.h"
+#include <iostream>
+#include <unordered_map>
+
+struct RegisteredBlock
+{
+    unsigned int Binding;
+    unsigned int Size;
+};
+
+static std::unordered_map<std::string, RegisteredBlock>& GetBlocks()
+{
+    static std::unordered_map<std::string, RegisteredBlock> blocks = {
+        { UniformBlock<FrameUniforms>::GetName(), { UniformBlock<FrameUniforms>::Binding, UniformBlockLayout<FrameUniforms>::Size() } },
+        { UniformBlock<ObjectUniforms>::GetName(), { UniformBlock<ObjectUniforms>::Binding, UniformBlockLayout<ObjectUniforms>::Size() } },
+    };
+    return blocks;
+}
+
+UniformBuffer::UniformBuffer(unsigned int size)
+    :m_Ring(GL_UNIFORM_BUFFER, size)
+{
+}
+
+UniformBuffer::~UniformBuffer()
+{
+}
+
+UniformBuffer::Range UniformBuffer::Allocate(unsigned int size, unsigned int count, char*& data)
+{
+    unsigned int alignment = m_Ring.GetMinAlignment();
+    unsigned int stride = (size + alignment - 1) / alignment * alignment;
+    StreamBuffer::Allocation allocation = m_Ring.Allocate(stride * count, alignment);
+    data = (char*)allocation.Data;
+    if (!data)
+        return { 0, stride, size, 0 };
+    m_Stats.Blocks += count;
+    m_Stats.Bytes += stride * count;
+    return { allocation.Offset, stride, size, count };
+}
+
+void UniformBuffer::BindRange(unsigned int binding, const Range& range, unsigned int index) const
+{
+    if (index >= range.Count)
+    {
+        std::cout << "[UniformBuffer] Block " << index << " of a range of " << range.Count << std::endl;
+        return;
+    }
+    m_Ring.BindRange(binding, { nullptr, range.Offset + index * range.Stride, range.Size });
+}
+
+void UniformBuffer::EndFrame()
+{
+    m_Ring.EndFrame();
+}
+
+void UniformBuffer::RegisterBlock(const std::string& name, unsigned int binding, unsigned int size)
+{
+    GetBlocks()[name] = { binding, size };
+}
+
+bool UniformBuffer::FindBlock(const std::string& name, unsigned int& binding, unsigned int& size)
+{
+    auto it = GetBlocks().find(name);
+    if (it == GetBlocks().end())
+        return false;
+    binding = it->second.Binding;
+    size = it->second.Size;
+    return true;
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <string>
+#include "StreamBuffer.h"
+#include "UniformBlock.h"
+
+//Uniform blocks (UniformBlock.h) written into one StreamBuffer ring and bound to their block's binding point.
+//Every program declaring a block reads it from that binding point, Shader points the program's blocks at theirs
+//when it links (RegisterBlock), so data shared by all programs is uploaded once and bound once:
+//
+//	uniforms.Set(frame); //FrameUniforms: the camera, once per frame
+//	UniformBuffer::Range objects = uniforms.Write(objectData.data(), count); //Per-object blocks, one allocation
+//	for (i...) { uniforms.Bind(objects, i); renderer.Draw(...); }
+//	uniforms.EndFrame();
+//
+//Range offsets are multiples of GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, up to 256 bytes a block on some drivers.
+class UniformBuffer
+{
+public:
+	struct Range
+	{
+		unsigned int Offset; //Of the first block, in bytes from the start of the ring
+		unsigned int Stride; //Between blocks
+		unsigned int Size; //Of one block
+		unsigned int Count; //0 if the ring had no room
+	};
+
+	struct Stats
+	{
+		unsigned int Blocks = 0; //Written since ResetStats
+		unsigned int Bytes = 0; //Ring space they took, alignment included
+	};
+
+	static const unsigned int DefaultSize = 4 * 1024 * 1024;
+private:
+	StreamBuffer m_Ring;
+	Stats m_Stats;
+public:
+	UniformBuffer(unsigned int size = DefaultSize); //Room for about three frames of blocks
+	~UniformBuffer();
+
+	UniformBuffer(const UniformBuffer&) = delete;
+	UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+	//Writes the block and binds it for the draws that follow
+	template<typename Block>
+	void Set(const Block& block)
+	{
+		Range range = Write(&block, 1);
+		if (range.Count)
+			Bind<Block>(range, 0);
+	}
+
+	//Writes count blocks back to back, ready to draw with. Bind picks the one a draw reads
+	template<typename Block>
+	Range Write(const Block* blocks, unsigned int count)
+	{
+		char* data;
+		Range range = Allocate(UniformBlockLayout<Block>::Size(), count, data);
+		for (unsigned int i = 0; i < range.Count; i++)
+			UniformBlockLayout<Block>::Write(blocks[i], data + i * range.Stride);
+		m_Ring.Commit();
+		return range;
+	}
+
+	template<typename Block>
+	void Bind(const Range& range, unsigned int index) const
+	{
+		BindRange(UniformBlock<Block>::Binding, range, index);
+	}
+	void BindRange(unsigned int binding, const Range& range, unsigned int index) const;
+
+	void EndFrame(); //After the frame's draws
+
+	inline const Stats& GetStats() const { return m_Stats; }
+	inline void ResetStats() { m_Stats = Stats(); }
+	inline const StreamBuffer& GetRing() const { return m_Ring; }
+
+	//Block names Shader binds, to the binding point and size a block has. Register a block before the programs that
+	//declare it link; FrameUniforms and ObjectUniforms are registered from the start.
+	template<typename Block>
+	static void RegisterBlock()
+	{
+		RegisterBlock(UniformBlock<Block>::GetName(), UniformBlock<Block>::Binding, UniformBlockLayout<Block>::Size());
+	}
+	static void RegisterBlock(const std::string& name, unsigned int binding, unsigned int size);
+	static bool FindBlock(const std::string& name, unsigned int& binding, unsigned int& size);
+private:
+	Range Allocate(unsigned int size, unsigned int count, char*& data); //Count 0 and no data if it doesn't fit
+};
+
+//Per-frame data every program can declare, written once a frame with Set:
+//	layout(std140) uniform Frame { mat4 u_ViewProj; mat4 u_View; mat4 u_Projection; vec3 u_CameraPosition; float u_Time; };
+struct FrameUniforms
+{
+	glm::mat4 ViewProjection;
+	glm::mat4 View;
+	glm::mat4 Projection;
+	glm::vec3 CameraPosition;
+	float Time; //Seconds
+};
+UNIFORM_BLOCK(FrameUniforms, "Frame", 0,
+	UNIFORM_MEMBER(FrameUniforms, ViewProjection),
+	UNIFORM_MEMBER(FrameUniforms, View),
+	UNIFORM_MEMBER(FrameUniforms, Projection),
+	UNIFORM_MEMBER(FrameUniforms, CameraPosition),
+	UNIFORM_MEMBER(FrameUniforms, Time))
+
+//Per-draw data, written for all objects at once and bound per draw:
+//	layout(std140) uniform Object { mat4 u_Model; vec4 u_Color; };
+struct ObjectUniforms
+{
+	glm::mat4 Model;
+	glm::vec4 Color;
+};
+UNIFORM_BLOCK(ObjectUniforms, "Object", 1,
+	UNIFORM_MEMBER(ObjectUniforms, Model),
+	UNIFORM_MEMBER(ObjectUniforms, Color))
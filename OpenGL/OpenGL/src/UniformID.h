@@ -0,0 +1,31 @@
+#pragma once
+
+//A uniform name as a 32 bit FNV-1a hash, what Shader looks uniforms up by. Built from a literal it is a constant
+//expression, so declared constexpr the hash costs nothing at run time:
+//  static constexpr UniformID s_MVP("u_MVP");
+//  shader.setUniformMat4f(s_MVP, mvp);
+//Passing the literal directly works too, the hash is then computed (cheaply) at the call. The name is kept for
+//warnings and must outlive the id, which it does for literals.
+class UniformID
+{
+private:
+	unsigned int m_Hash;
+	const char* m_Name;
+public:
+	constexpr UniformID(const char* name)
+		: m_Hash(Hash(name)), m_Name(name) {}
+
+	static constexpr unsigned int Hash(const char* name)
+	{
+		unsigned int hash = 2166136261u;
+		for (; *name; name++)
+		{
+			hash ^= (unsigned char)*name;
+			hash *= 16777619u;
+		}
+		return hash;
+	}
+
+	inline constexpr unsigned int GetHash() const { return m_Hash; }
+	inline constexpr const char* GetName() const { return m_Name; }
+};
@@ -1,8 +1,13 @@
 #include "VertexArray.h"
 #include "VertexBufferLayout.h"
 #include "Renderer.h"
+#include "GLStateCache.h"
+#include "StreamBuffer.h"
+#include "DeletionQueue.h"
+#include <utility>
 
 VertexArray::VertexArray()
+	:m_AttribCount(0)
 {
 	GLCall(glGenVertexArrays(1, &m_RendererID));
 	
@@ -10,30 +15,77 @@ VertexArray::VertexArray()
 
 VertexArray::~VertexArray()
 {
-	GLCall(glDeleteVertexArrays(1, &m_RendererID));
+	DeletionQueue::Get().Enqueue(DeletionQueue::Type::VertexArray, m_RendererID);
+}
+
+VertexArray::VertexArray(VertexArray&& other) noexcept
+	:m_RendererID(other.m_RendererID), m_AttribCount(other.m_AttribCount)
+{
+	other.m_RendererID = 0;
+	other.m_AttribCount = 0;
+}
+
+VertexArray& VertexArray::operator=(VertexArray&& other) noexcept
+{
+	//Swapped, other's destructor deletes the vertex array this one held
+	std::swap(m_RendererID, other.m_RendererID);
+	std::swap(m_AttribCount, other.m_AttribCount);
+	return *this;
 }
 
 void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout)
 {
 	Bind();
 	vb.Bind();
+	AddLayout(layout);
+}
+
+void VertexArray::AddBuffer(const StreamBuffer& sb, const VertexBufferLayout& layout)
+{
+	Bind();
+	BindStreamBuffer(sb);
+	AddLayout(layout);
+}
+
+void VertexArray::BindStreamBuffer(const StreamBuffer& sb)
+{
+	sb.Bind();
+}
+
+void VertexArray::AddLayout(const VertexBufferLayout& layout)
+{
 	const auto& elements = layout.GetElements();
 	unsigned int offset = 0;
 	for (unsigned int i = 0; i < elements.size();i++) {
 		const auto& element = elements[i];
-		GLCall(glEnableVertexAttribArray(i)); //Enable the vertex attribute
-		GLCall(glVertexAttribPointer(i, element.count, element.type, element.normalized , layout.GetStride(), (const void*)offset));
-		offset += element.count * VertexBufferElement::GetSizeofType(element.type);
+		AddAttribute(m_AttribCount + i, element.type, element.count, element.normalized != 0, element.integer != 0, layout.GetStride(), offset, element.divisor);
+		offset += element.GetSize();
+	}
+	m_AttribCount += (unsigned int)elements.size();
+
+}
+
+void VertexArray::AddAttribute(unsigned int index, unsigned int type, unsigned int count, bool normalized, bool integer,
+	unsigned int stride, unsigned int offset, unsigned int divisor)
+{
+	GLCall(glEnableVertexAttribArray(index)); //Enable the vertex attribute
+	if (integer) {
+		GLCall(glVertexAttribIPointer(index, count, type, stride, (const void*)(size_t)offset));
+	}
+	else {
+		GLCall(glVertexAttribPointer(index, count, type, normalized ? GL_TRUE : GL_FALSE, stride, (const void*)(size_t)offset));
+	}
+	if (divisor) {
+		GLCall(glVertexAttribDivisor(index, divisor));
 	}
-	
 }
 
 void VertexArray::Bind() const
 {
-	GLCall(glBindVertexArray(m_RendererID));
+	GLStateCache::Get().BindVertexArray(m_RendererID);
 }
 
 void VertexArray::Unbind() const
 {
-	GLCall(glBindVertexArray(0));
+	GLStateCache::Get().BindVertexArray(0);
 }
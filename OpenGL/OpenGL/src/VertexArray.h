@@ -1,18 +1,71 @@
 #pragma once
 
 #include "VertexBuffer.h"
+#include "VertexFormat.h"
+#include <utility>
 
 class VertexBufferLayout;
+class StreamBuffer;
 
 class VertexArray {
 private:
 	unsigned int m_RendererID;
+	unsigned int m_AttribCount; //Next free attribute index, buffers added later continue from here
 public:
 	VertexArray();
 	~VertexArray();
 
+	//Owns the GL vertex array: move-only, a moved-from VertexArray is empty
+	VertexArray(const VertexArray&) = delete;
+	VertexArray& operator=(const VertexArray&) = delete;
+	VertexArray(VertexArray&& other) noexcept;
+	VertexArray& operator=(VertexArray&& other) noexcept;
+
+	//Can be called once per buffer, e.g. per-vertex data first and per-instance data (divisor 1) after it
 	void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout);
+	//Attributes start at offset 0 of the ring, draw with the allocation's offset as baseVertex
+	void AddBuffer(const StreamBuffer& sb, const VertexBufferLayout& layout);
+
+	//Same, for a vertex struct described with VERTEX_FORMAT: the layout is fixed at compile time and nothing is allocated
+	template<typename Vertex>
+	void AddBuffer(const VertexBuffer& vb, unsigned int divisor = 0)
+	{
+		Bind();
+		vb.Bind();
+		AddAttributes<Vertex>(divisor, std::make_index_sequence<VertexLayout<Vertex>::Count>());
+	}
+
+	template<typename Vertex>
+	void AddBuffer(const StreamBuffer& sb, unsigned int divisor = 0)
+	{
+		Bind();
+		BindStreamBuffer(sb);
+		AddAttributes<Vertex>(divisor, std::make_index_sequence<VertexLayout<Vertex>::Count>());
+	}
 
 	void Bind() const;
 	void Unbind() const;
+private:
+	void AddLayout(const VertexBufferLayout& layout); //For the buffer bound to GL_ARRAY_BUFFER
+	void AddAttribute(unsigned int index, unsigned int type, unsigned int count, bool normalized, bool integer,
+		unsigned int stride, unsigned int offset, unsigned int divisor);
+	void BindStreamBuffer(const StreamBuffer& sb); //StreamBuffer is only forward declared here
+
+	template<typename Vertex, size_t... I>
+	void AddAttributes(unsigned int divisor, std::index_sequence<I...>)
+	{
+		//Unrolled, one call per attribute with its format and offset as constants
+		int unrolled[] = { 0, (AddAttribute<Vertex, I>(divisor), 0)... };
+		(void)unrolled;
+		m_AttribCount += VertexLayout<Vertex>::Count;
+	}
+
+	template<typename Vertex, size_t I>
+	void AddAttribute(unsigned int divisor)
+	{
+		constexpr VertexAttribute attribute = VertexFormat<Vertex>::Get(I);
+		constexpr unsigned int offset = VertexLayout<Vertex>::Offset(I);
+		AddAttribute(m_AttribCount + (unsigned int)I, attribute.type, attribute.count, attribute.normalized != 0, attribute.integer != 0,
+			VertexLayout<Vertex>::Stride, offset, divisor);
+	}
 };
\ No newline at end of file
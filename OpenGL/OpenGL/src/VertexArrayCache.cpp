@@ -0,0 +1,208 @@
+#include "VertexArrayCache.h"
+#include "VertexBuffer.h"
+#include "GLStateCache.h"
+#include "DeletionQueue.h"
+
+//Names are never 0xffffffff, so the first Bind of every stream goes through
+static const unsigned int s_Unbound = 0xffffffff;
+
+static void HashCombine(size_t& hash, size_t value)
+{
+    hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+}
+
+unsigned int VertexStreamLayout::AddStream(const VertexBufferLayout& layout)
+{
+    ASSERT(m_Streams.size() < VertexArrayCache::MaxStreams);
+    for (const VertexBufferElement& element : layout.GetElements())
+    {
+        ASSERT(element.divisor == layout.GetElements()[0].divisor);
+        HashCombine(m_Hash, element.type);
+        HashCombine(m_Hash, element.count);
+        HashCombine(m_Hash, element.normalized);
+        HashCombine(m_Hash, element.integer);
+        HashCombine(m_Hash, element.divisor);
+    }
+    HashCombine(m_Hash, layout.GetStride()); //Also marks where one stream ends and the next begins
+    m_Streams.push_back(layout);
+    return (unsigned int)m_Streams.size() - 1;
+}
+
+bool VertexStreamLayout::operator==(const VertexStreamLayout& other) const
+{
+    if (m_Hash != other.m_Hash || m_Streams.size() != other.m_Streams.size())
+        return false;
+    for (size_t stream = 0; stream < m_Streams.size(); stream++)
+    {
+        const auto& elements = m_Streams[stream].GetElements();
+        const auto& otherElements = other.m_Streams[stream].GetElements();
+        if (elements.size() != otherElements.size() || m_Streams[stream].GetStride() != other.m_Streams[stream].GetStride())
+            return false;
+        for (size_t i = 0; i < elements.size(); i++)
+        {
+            const VertexBufferElement& a = elements[i];
+            const VertexBufferElement& b = otherElements[i];
+            if (a.type != b.type || a.count != b.count || a.normalized != b.normalized || a.integer != b.integer || a.divisor != b.divisor)
+                return false;
+        }
+    }
+    return true;
+}
+
+VertexArrayCache::VertexArrayCache()
+    :m_AttribBinding(IsAttribBindingSupported())
+{
+}
+
+VertexArrayCache::~VertexArrayCache()
+{
+    Clear();
+}
+
+VertexArrayCache& VertexArrayCache::Get()
+{
+    thread_local VertexArrayCache cache;
+    return cache;
+}
+
+bool VertexArrayCache::IsAttribBindingSupported()
+{
+    return GLEW_VERSION_4_3 || GLEW_ARB_vertex_attrib_binding;
+}
+
+void VertexArrayCache::Bind(const VertexStreamLayout& layout, const VertexBuffer* const* buffers, const unsigned int* offsets)
+{
+    Format& format = GetFormat(layout);
+    GLStateCache::Get().BindVertexArray(format.RendererID);
+
+    for (unsigned int stream = 0; stream < layout.GetStreamCount(); stream++)
+    {
+        unsigned int buffer = buffers[stream]->GetRendererID();
+        unsigned int offset = offsets ? offsets[stream] : 0;
+        if (format.Buffers[stream] == buffer && format.Offsets[stream] == offset)
+        {
+            m_Stats.BufferBindsSkipped++;
+            continue;
+        }
+
+        if (m_AttribBinding)
+        {
+            GLCall(glBindVertexBuffer(stream, buffer, offset, layout.GetStreams()[stream].GetStride()));
+        }
+        else
+        {
+            GLStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, buffer);
+            SetStreamPointers(layout, stream, offset);
+        }
+        format.Buffers[stream] = buffer;
+        format.Offsets[stream] = offset;
+        m_Stats.BufferBinds++;
+    }
+}
+
+void VertexArrayCache::SetAttribBindingEnabled(bool enabled)
+{
+    Clear();
+    m_AttribBinding = enabled && IsAttribBindingSupported();
+}
+
+void VertexArrayCache::OnDeleteBuffer(unsigned int buffer)
+{
+    for (Format& format : m_Formats)
+    {
+        for (unsigned int stream = 0; stream < MaxStreams; stream++)
+        {
+            if (format.Buffers[stream] == buffer)
+                format.Buffers[stream] = s_Unbound;
+        }
+    }
+}
+
+void VertexArrayCache::Clear()
+{
+    for (const Format& format : m_Formats)
+        DeletionQueue::Get().Enqueue(DeletionQueue::Type::VertexArray, format.RendererID);
+    m_Formats.clear();
+    m_FormatsByHash.clear();
+    m_Stats.VertexArrays = 0;
+}
+
+VertexArrayCache::Format& VertexArrayCache::GetFormat(const VertexStreamLayout& layout)
+{
+    auto range = m_FormatsByHash.equal_range(layout.GetHash());
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (m_Formats[it->second].Layout == layout)
+            return m_Formats[it->second];
+    }
+
+    Format format;
+    format.Layout = layout;
+    GLCall(glGenVertexArrays(1, &format.RendererID));
+    for (unsigned int stream = 0; stream < MaxStreams; stream++)
+    {
+        format.Buffers[stream] = s_Unbound;
+        format.Offsets[stream] = 0;
+    }
+
+    GLStateCache::Get().BindVertexArray(format.RendererID);
+    unsigned int index = 0;
+    for (unsigned int stream = 0; stream < layout.GetStreamCount(); stream++)
+    {
+        const auto& elements = layout.GetStreams()[stream].GetElements();
+        unsigned int offset = 0;
+        for (const VertexBufferElement& element : elements)
+        {
+            GLCall(glEnableVertexAttribArray(index));
+            if (m_AttribBinding)
+            {
+                if (element.integer)
+                {
+                    GLCall(glVertexAttribIFormat(index, element.count, element.type, offset));
+                }
+                else
+                {
+                    GLCall(glVertexAttribFormat(index, element.count, element.type, element.normalized, offset));
+                }
+                GLCall(glVertexAttribBinding(index, stream));
+            }
+            else if (element.divisor)
+            {
+                GLCall(glVertexAttribDivisor(index, element.divisor));
+            }
+            offset += element.GetSize();
+            index++;
+        }
+        if (m_AttribBinding && !elements.empty() && elements[0].divisor)
+        {
+            GLCall(glVertexBindingDivisor(stream, elements[0].divisor));
+        }
+    }
+
+    m_Formats.push_back(format);
+    m_FormatsByHash.insert({ layout.GetHash(), (unsigned int)m_Formats.size() - 1 });
+    m_Stats.VertexArrays++;
+    return m_Formats.back();
+}
+
+void VertexArrayCache::SetStreamPointers(const VertexStreamLayout& layout, unsigned int stream, unsigned int offset)
+{
+    unsigned int index = 0;
+    for (unsigned int previous = 0; previous < stream; previous++)
+        index += (unsigned int)layout.GetStreams()[previous].GetElements().size();
+
+    const VertexBufferLayout& streamLayout = layout.GetStreams()[stream];
+    for (const VertexBufferElement& element : streamLayout.GetElements())
+    {
+        if (element.integer)
+        {
+            GLCall(glVertexAttribIPointer(index, element.count, element.type, streamLayout.GetStride(), (const void*)(size_t)offset));
+        }
+        else
+        {
+            GLCall(glVertexAttribPointer(index, element.count, element.type, element.normalized, streamLayout.GetStride(), (const void*)(size_t)offset));
+        }
+        offset += element.GetSize();
+        index++;
+    }
+}
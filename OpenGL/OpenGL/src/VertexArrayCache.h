@@ -0,0 +1,83 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include "VertexBufferLayout.h"
+
+class VertexBuffer;
+
+//Attributes spread over several vertex buffers, one VertexBufferLayout per stream. E.g. positions in stream 0 and
+//everything else in stream 1, so a depth pre-pass can use a layout with stream 0 only and read nothing else.
+//Attribute locations continue from one stream to the next, like repeated VertexArray::AddBuffer calls.
+//Every element of a stream must use the same divisor.
+class VertexStreamLayout
+{
+private:
+	std::vector<VertexBufferLayout> m_Streams;
+	size_t m_Hash;
+public:
+	VertexStreamLayout()
+		: m_Hash(0) {}
+
+	unsigned int AddStream(const VertexBufferLayout& layout); //Returns the stream index
+
+	bool operator==(const VertexStreamLayout& other) const;
+
+	inline const std::vector<VertexBufferLayout>& GetStreams() const { return m_Streams; }
+	inline unsigned int GetStreamCount() const { return (unsigned int)m_Streams.size(); }
+	inline size_t GetHash() const { return m_Hash; }
+};
+
+//One vertex array object per vertex format instead of one per mesh. Meshes with the same VertexStreamLayout share it
+//and only their buffers change between draws, so vertex arrays and vertex array switches come down to the number of
+//distinct formats. With GL 4.3 / ARB_vertex_attrib_binding the format is set up once (glVertexAttribFormat) and
+//buffers are swapped with glBindVertexBuffer. Without it the attributes of the shared vertex array are re-pointed.
+//Vertex arrays aren't shared between contexts, so like GLStateCache there is one cache per thread (Get(), after glewInit).
+class VertexArrayCache
+{
+public:
+	static const unsigned int MaxStreams = 8;
+
+	struct Stats
+	{
+		unsigned int VertexArrays = 0; //One per format
+		unsigned int BufferBinds = 0;
+		unsigned int BufferBindsSkipped = 0; //Stream already had that buffer and offset
+	};
+private:
+	struct Format
+	{
+		VertexStreamLayout Layout;
+		unsigned int RendererID;
+		unsigned int Buffers[MaxStreams]; //What each stream has bound now
+		unsigned int Offsets[MaxStreams];
+	};
+
+	std::vector<Format> m_Formats;
+	std::unordered_multimap<size_t, unsigned int> m_FormatsByHash; //Layout hash to index in m_Formats
+	bool m_AttribBinding;
+	Stats m_Stats;
+public:
+	VertexArrayCache();
+	~VertexArrayCache();
+
+	static VertexArrayCache& Get();
+	static bool IsAttribBindingSupported();
+
+	//Binds the vertex array for layout, with buffers[i] as stream i starting offsets[i] bytes in (all 0 if offsets is nullptr).
+	//The element buffer binding belongs to the vertex array, bind the index buffer after this.
+	void Bind(const VertexStreamLayout& layout, const VertexBuffer* const* buffers, const unsigned int* offsets = nullptr);
+
+	//Off re-points attributes even where vertex attrib binding is supported, for comparison. Clears the cache.
+	void SetAttribBindingEnabled(bool enabled);
+	inline bool IsAttribBindingEnabled() const { return m_AttribBinding; }
+
+	void OnDeleteBuffer(unsigned int buffer); //The name may come back for another buffer
+	void Clear(); //Deletes the vertex arrays through the DeletionQueue
+
+	inline const Stats& GetStats() const { return m_Stats; }
+	inline void ResetStats() { m_Stats.BufferBinds = 0; m_Stats.BufferBindsSkipped = 0; } //Call once per frame
+private:
+	Format& GetFormat(const VertexStreamLayout& layout);
+	void SetStreamPointers(const VertexStreamLayout& layout, unsigned int stream, unsigned int offset); //Fallback path
+};
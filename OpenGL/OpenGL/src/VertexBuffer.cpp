@@ -1,24 +1,84 @@
 #include "VertexBuffer.h"
 #include "Renderer.h"
+#include "GLStateCache.h"
+#include "Profiler.h"
+#include "DeletionQueue.h"
+#include "GpuMemory.h"
+#include <utility>
 
 VertexBuffer::VertexBuffer(const void* data, unsigned int size)
+    :m_Size(size), m_Refused(false)
 {
     GLCall(glGenBuffers(1, &m_RendererID)); //One buffer and pointer to a unsigned int--> Generating a buffer and giving us an ID to refer later.
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID)); //Selecting(glbind**) the above buffer
-    GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW)); //Put the data into the buffer
+    GLStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, m_RendererID); //Selecting(glbind**) the above buffer
+    if (!GpuMemory::Get().Allocate(GpuMemory::Category::VertexBuffer, m_RendererID, size))
+    {
+        m_Size = 0; //Over budget, the buffer stays empty
+        m_Refused = true;
+    }
+    GLCall(glBufferData(GL_ARRAY_BUFFER, m_Size, m_Size ? data : nullptr, GL_STATIC_DRAW)); //Put the data into the buffer
+    GLStateCache::Get().OnUpload(m_Size);
+}
+
+VertexBuffer::VertexBuffer(unsigned int size)
+    :m_Size(size), m_Refused(false)
+{
+    GLCall(glGenBuffers(1, &m_RendererID));
+    GLStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+    if (!GpuMemory::Get().Allocate(GpuMemory::Category::VertexBuffer, m_RendererID, size))
+    {
+        m_Size = 0;
+        m_Refused = true;
+    }
+    GLCall(glBufferData(GL_ARRAY_BUFFER, m_Size, nullptr, GL_DYNAMIC_DRAW)); //Allocate only, the data comes every frame
 }
 
 VertexBuffer::~VertexBuffer()
 {
-    GLCall(glDeleteBuffers(1, &m_RendererID));
+    DeletionQueue::Get().Enqueue(DeletionQueue::Type::Buffer, m_RendererID, m_Size);
+}
+
+VertexBuffer::VertexBuffer(VertexBuffer&& other) noexcept
+    :m_RendererID(other.m_RendererID), m_Size(other.m_Size), m_Refused(other.m_Refused)
+{
+    other.m_RendererID = 0;
+    other.m_Size = 0;
+}
+
+VertexBuffer& VertexBuffer::operator=(VertexBuffer&& other) noexcept
+{
+    //Swapped, other's destructor deletes the buffer this one held
+    std::swap(m_RendererID, other.m_RendererID);
+    std::swap(m_Size, other.m_Size);
+    std::swap(m_Refused, other.m_Refused);
+    return *this;
 }
 
 void VertexBuffer::Bind() const
 {
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID)); //Selecting(glbind**)
+    GLStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, m_RendererID); //Selecting(glbind**)
+}
+
+void VertexBuffer::SetLabel(const std::string& label)
+{
+    GpuMemory::Get().SetLabel(GpuMemory::Category::VertexBuffer, m_RendererID, label);
+}
+
+bool VertexBuffer::SetData(const void* data, unsigned int size, unsigned int offset)
+{
+    PROFILE_SCOPE("VertexBuffer::SetData");
+    if (m_Refused)
+        return false; //Reported by GpuMemory when it refused
+    ASSERT(offset + size <= m_Size);
+    if (offset + size > m_Size)
+        return false;
+    Bind();
+    GLCall(glBufferSubData(GL_ARRAY_BUFFER, offset, size, data));
+    GLStateCache::Get().OnUpload(size);
+    return true;
 }
 
 void VertexBuffer::Unbind() const
 {
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0)); 
+    GLStateCache::Get().BindBuffer(GL_ARRAY_BUFFER, 0);
 }
@@ -1,12 +1,32 @@
 #pragma once
 
+#include <string>
+
 class VertexBuffer {
 private:
 	unsigned int m_RendererID;
+	unsigned int m_Size; //In bytes
+	bool m_Refused; //GpuMemory refused the storage, SetData has nowhere to write
 public:
+	//Either constructor leaves the buffer empty (GetSize() 0) when GpuMemory refuses the size
 	VertexBuffer(const void* data, unsigned int size);
+	VertexBuffer(unsigned int size); //Dynamic buffer, filled later through SetData
 	~VertexBuffer();
 
+	//Owns the GL buffer: move-only, a moved-from VertexBuffer is empty
+	VertexBuffer(const VertexBuffer&) = delete;
+	VertexBuffer& operator=(const VertexBuffer&) = delete;
+	VertexBuffer(VertexBuffer&& other) noexcept;
+	VertexBuffer& operator=(VertexBuffer&& other) noexcept;
+
+	//False, with nothing written, when the storage was refused; a write past the end asserts
+	bool SetData(const void* data, unsigned int size, unsigned int offset = 0);
+	void SetLabel(const std::string& label); //Name it is accounted under in GpuMemory
+
 	void Bind() const;
 	void Unbind() const;
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline unsigned int GetSize() const { return m_Size; }
+	inline bool IsRefused() const { return m_Refused; }
 };
\ No newline at end of file
@@ -3,22 +3,22 @@
 #include <vector>
 #include <GL/glew.h>
 #include "Renderer.h"
+#include "VertexFormat.h"
 
 struct VertexBufferElement {
 	unsigned int type;
 	unsigned int count;
 	unsigned char normalized;
+	unsigned int divisor; //0 = per vertex, N = advance once every N instances
+	unsigned char integer; //Read as int/uint in the shader (glVertexAttribIPointer) instead of converted to float
 
 	static unsigned int GetSizeofType(unsigned int type) {
-		switch (type)
-		{
-			case GL_FLOAT:          return 4;
-			case GL_UNSIGNED_INT:   return 4;
-			case GL_UNSIGNED_BYTE:  return 1;
-		}
-		ASSERT(false);
-		return 0;
+		unsigned int size = VertexAttribute::GetSizeofType(type);
+		ASSERT(size != 0);
+		return size;
 	}
+
+	inline unsigned int GetSize() const { return type == GL_INT_2_10_10_10_REV ? 4 : count * GetSizeofType(type); }
 };
 
 class VertexBufferLayout {
@@ -33,33 +33,72 @@ public:
 
 	~VertexBufferLayout() {};
 
+	//Specialized below for float, unsigned int, unsigned char, short and unsigned short, other types don't compile
 	template<typename T>
-	void Push(unsigned int count)
+	void Push(unsigned int /*count*/, unsigned int /*divisor*/ = 0)
 	{
-		static_assert(false);
+		static_assert(sizeof(T) == 0, "unsupported vertex attribute type");
 	}
 
-	template<>
-	void Push<float>(unsigned int count)
+	//16-bit floats, filled with VertexConvert::FloatToHalf
+	void PushHalf(unsigned int count, unsigned int divisor = 0)
 	{
-		m_Elements.push_back({ GL_FLOAT,count,GL_FALSE });
-		m_Stride += count *  VertexBufferElement::GetSizeofType(GL_FLOAT);
+		m_Elements.push_back({ GL_HALF_FLOAT,count,GL_FALSE,divisor,GL_FALSE });
+		m_Stride += count * VertexBufferElement::GetSizeofType(GL_HALF_FLOAT);
 	}
 
-	template<>
-	void Push<unsigned int>(unsigned int count)
+	//Four signed normalized components in 32 bits (10/10/10/2), for normals and tangents.
+	//Filled with VertexConvert::PackSnorm10_10_10_2
+	void PushPacked(unsigned int divisor = 0)
 	{
-		m_Elements.push_back({ GL_UNSIGNED_INT,count,GL_FALSE });
-		m_Stride += count * VertexBufferElement::GetSizeofType(GL_UNSIGNED_INT);
+		m_Elements.push_back({ GL_INT_2_10_10_10_REV,4,GL_TRUE,divisor,GL_FALSE });
+		m_Stride += VertexBufferElement::GetSizeofType(GL_INT_2_10_10_10_REV);
 	}
 
-	template<>
-	void Push<unsigned char>(unsigned int count)
+	//Integer attributes (ivec/uvec in the shader), type is GL_BYTE/GL_SHORT/GL_INT or their unsigned variants
+	void PushInteger(unsigned int type, unsigned int count, unsigned int divisor = 0)
 	{
-		m_Elements.push_back({ GL_UNSIGNED_BYTE,count,GL_TRUE });
-		m_Stride += count *  VertexBufferElement::GetSizeofType(GL_UNSIGNED_BYTE);
+		m_Elements.push_back({ type,count,GL_FALSE,divisor,GL_TRUE });
+		m_Stride += count * VertexBufferElement::GetSizeofType(type);
 	}
 
-	inline const std::vector<VertexBufferElement> GetElements() const { return m_Elements; }
+	inline const std::vector<VertexBufferElement>& GetElements() const { return m_Elements; }
 	inline unsigned int GetStride() const { return m_Stride; }
-};
\ No newline at end of file
+};
+
+template<>
+inline void VertexBufferLayout::Push<float>(unsigned int count, unsigned int divisor)
+{
+	m_Elements.push_back({ GL_FLOAT,count,GL_FALSE,divisor,GL_FALSE });
+	m_Stride += count *  VertexBufferElement::GetSizeofType(GL_FLOAT);
+}
+
+template<>
+inline void VertexBufferLayout::Push<unsigned int>(unsigned int count, unsigned int divisor)
+{
+	m_Elements.push_back({ GL_UNSIGNED_INT,count,GL_FALSE,divisor,GL_FALSE });
+	m_Stride += count * VertexBufferElement::GetSizeofType(GL_UNSIGNED_INT);
+}
+
+template<>
+inline void VertexBufferLayout::Push<unsigned char>(unsigned int count, unsigned int divisor)
+{
+	m_Elements.push_back({ GL_UNSIGNED_BYTE,count,GL_TRUE,divisor,GL_FALSE });
+	m_Stride += count *  VertexBufferElement::GetSizeofType(GL_UNSIGNED_BYTE);
+}
+
+//Normalized: -32767..32767 reads as -1..1 in the shader
+template<>
+inline void VertexBufferLayout::Push<short>(unsigned int count, unsigned int divisor)
+{
+	m_Elements.push_back({ GL_SHORT,count,GL_TRUE,divisor,GL_FALSE });
+	m_Stride += count * VertexBufferElement::GetSizeofType(GL_SHORT);
+}
+
+//Normalized: 0..65535 reads as 0..1 in the shader
+template<>
+inline void VertexBufferLayout::Push<unsigned short>(unsigned int count, unsigned int divisor)
+{
+	m_Elements.push_back({ GL_UNSIGNED_SHORT,count,GL_TRUE,divisor,GL_FALSE });
+	m_Stride += count * VertexBufferElement::GetSizeofType(GL_UNSIGNED_SHORT);
+}
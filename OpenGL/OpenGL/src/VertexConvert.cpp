@@ -0,0 +1,173 @@
+#include "VertexConvert.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define VERTEX_CONVERT_SSE2
+    #include <emmintrin.h>
+#endif
+
+//Scalar conversions, rounding like cvtps2dq does under the default rounding mode (to nearest even)
+static inline int Round(float value)
+{
+    return (int)lrintf(value);
+}
+
+static inline float Clamp(float value, float low, float high)
+{
+    return std::min(std::max(value, low), high);
+}
+
+uint16_t VertexConvert::FloatToHalf(float value)
+{
+    //After F. Giesen's float_to_half_fast3_rtne
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = bits & 0x80000000u;
+    bits ^= sign;
+
+    uint16_t half;
+    if (bits >= (143u << 23)) //Too large for a half (or inf/NaN)
+        half = bits > 0x7f800000u ? 0x7e00 : 0x7c00;
+    else if (bits < (113u << 23)) //Subnormal half or zero: let the float adder do the rounding
+    {
+        const uint32_t magicBits = 126u << 23;
+        float magic, sum;
+        memcpy(&magic, &magicBits, sizeof(magic));
+        memcpy(&sum, &bits, sizeof(sum));
+        sum += magic;
+        uint32_t sumBits;
+        memcpy(&sumBits, &sum, sizeof(sumBits));
+        half = (uint16_t)(sumBits - magicBits);
+    }
+    else
+    {
+        uint32_t mantissaOdd = (bits >> 13) & 1;
+        bits += ((uint32_t)(15 - 127) << 23) + 0xfff;
+        bits += mantissaOdd;
+        half = (uint16_t)(bits >> 13);
+    }
+    return half | (uint16_t)(sign >> 16);
+}
+
+#ifdef VERTEX_CONVERT_SSE2
+//Four lanes of the scalar FloatToHalf above, results in the low 16 bits of each lane (sign extended)
+static inline __m128i FloatToHalf4(__m128 value)
+{
+    const __m128i halfMax = _mm_set1_epi32(143 << 23);
+    const __m128i minNormal = _mm_set1_epi32(113 << 23);
+    const __m128i subnormalMagic = _mm_set1_epi32(126 << 23);
+    const __m128i normalBias = _mm_set1_epi32(0xfff - (112 << 23));
+
+    __m128 sign = _mm_and_ps(value, _mm_castsi128_ps(_mm_set1_epi32((int)0x80000000u)));
+    __m128 absolute = _mm_xor_ps(value, sign);
+    __m128i bits = _mm_castps_si128(absolute);
+
+    __m128 isNaN = _mm_cmpunord_ps(absolute, absolute);
+    __m128i isRegular = _mm_cmpgt_epi32(halfMax, bits);
+    __m128i special = _mm_or_si128(_mm_and_si128(_mm_castps_si128(isNaN), _mm_set1_epi32(0x200)), _mm_set1_epi32(0x7c00));
+
+    __m128i isSubnormal = _mm_cmpgt_epi32(minNormal, bits);
+    __m128i subnormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(absolute, _mm_castsi128_ps(subnormalMagic))), subnormalMagic);
+
+    __m128i mantissaOdd = _mm_srai_epi32(_mm_slli_epi32(bits, 31 - 13), 31); //-1 when odd
+    __m128i normal = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(bits, normalBias), mantissaOdd), 13);
+
+    __m128i finite = _mm_or_si128(_mm_and_si128(isSubnormal, subnormal), _mm_andnot_si128(isSubnormal, normal));
+    __m128i joined = _mm_or_si128(_mm_and_si128(isRegular, finite), _mm_andnot_si128(isRegular, special));
+    return _mm_or_si128(joined, _mm_srai_epi32(_mm_castps_si128(sign), 16));
+}
+#endif
+
+void VertexConvert::FloatToHalf(uint16_t* destination, const float* source, unsigned int count)
+{
+    unsigned int i = 0;
+#ifdef VERTEX_CONVERT_SSE2
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i low = FloatToHalf4(_mm_loadu_ps(source + i));
+        __m128i high = FloatToHalf4(_mm_loadu_ps(source + i + 4));
+        //Lanes are sign extended 16-bit values, so the saturating pack keeps them as they are
+        _mm_storeu_si128((__m128i*)(destination + i), _mm_packs_epi32(low, high));
+    }
+#endif
+    for (; i < count; i++)
+        destination[i] = FloatToHalf(source[i]);
+}
+
+void VertexConvert::FloatToSnorm16(int16_t* destination, const float* source, unsigned int count)
+{
+    unsigned int i = 0;
+#ifdef VERTEX_CONVERT_SSE2
+    const __m128 low = _mm_set1_ps(-1.0f), high = _mm_set1_ps(1.0f), scale = _mm_set1_ps(32767.0f);
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i a = _mm_cvtps_epi32(_mm_mul_ps(_mm_max_ps(_mm_min_ps(_mm_loadu_ps(source + i), high), low), scale));
+        __m128i b = _mm_cvtps_epi32(_mm_mul_ps(_mm_max_ps(_mm_min_ps(_mm_loadu_ps(source + i + 4), high), low), scale));
+        _mm_storeu_si128((__m128i*)(destination + i), _mm_packs_epi32(a, b));
+    }
+#endif
+    for (; i < count; i++)
+        destination[i] = (int16_t)Round(Clamp(source[i], -1.0f, 1.0f) * 32767.0f);
+}
+
+void VertexConvert::FloatToUnorm16(uint16_t* destination, const float* source, unsigned int count)
+{
+    unsigned int i = 0;
+#ifdef VERTEX_CONVERT_SSE2
+    const __m128 low = _mm_setzero_ps(), high = _mm_set1_ps(1.0f), scale = _mm_set1_ps(65535.0f);
+    const __m128i bias = _mm_set1_epi32(32768);
+    const __m128i flip = _mm_set1_epi16((short)0x8000);
+    for (; i + 8 <= count; i += 8)
+    {
+        //SSE2 only has a signed 32 -> 16 pack: shift into signed range, pack, shift back
+        __m128i a = _mm_sub_epi32(_mm_cvtps_epi32(_mm_mul_ps(_mm_max_ps(_mm_min_ps(_mm_loadu_ps(source + i), high), low), scale)), bias);
+        __m128i b = _mm_sub_epi32(_mm_cvtps_epi32(_mm_mul_ps(_mm_max_ps(_mm_min_ps(_mm_loadu_ps(source + i + 4), high), low), scale)), bias);
+        _mm_storeu_si128((__m128i*)(destination + i), _mm_xor_si128(_mm_packs_epi32(a, b), flip));
+    }
+#endif
+    for (; i < count; i++)
+        destination[i] = (uint16_t)Round(Clamp(source[i], 0.0f, 1.0f) * 65535.0f);
+}
+
+void VertexConvert::FloatToUnorm8(uint8_t* destination, const float* source, unsigned int count)
+{
+    unsigned int i = 0;
+#ifdef VERTEX_CONVERT_SSE2
+    const __m128 low = _mm_setzero_ps(), high = _mm_set1_ps(1.0f), scale = _mm_set1_ps(255.0f);
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i v[4];
+        for (int j = 0; j < 4; j++)
+            v[j] = _mm_cvtps_epi32(_mm_mul_ps(_mm_max_ps(_mm_min_ps(_mm_loadu_ps(source + i + j * 4), high), low), scale));
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(v[0], v[1]), _mm_packs_epi32(v[2], v[3]));
+        _mm_storeu_si128((__m128i*)(destination + i), packed);
+    }
+#endif
+    for (; i < count; i++)
+        destination[i] = (uint8_t)Round(Clamp(source[i], 0.0f, 1.0f) * 255.0f);
+}
+
+void VertexConvert::PackSnorm10_10_10_2(uint32_t* destination, const float* source, unsigned int count, unsigned int components)
+{
+    for (unsigned int i = 0; i < count; i++)
+    {
+        const float* vertex = source + (size_t)i * components;
+        int x, y, z, w;
+#ifdef VERTEX_CONVERT_SSE2
+        __m128 value = components == 4 ? _mm_loadu_ps(vertex) : _mm_setr_ps(vertex[0], vertex[1], vertex[2], 0.0f);
+        value = _mm_max_ps(_mm_min_ps(value, _mm_set1_ps(1.0f)), _mm_set1_ps(-1.0f));
+        int lanes[4];
+        _mm_storeu_si128((__m128i*)lanes, _mm_cvtps_epi32(_mm_mul_ps(value, _mm_setr_ps(511.0f, 511.0f, 511.0f, 1.0f))));
+        x = lanes[0]; y = lanes[1]; z = lanes[2]; w = lanes[3];
+#else
+        x = Round(Clamp(vertex[0], -1.0f, 1.0f) * 511.0f);
+        y = Round(Clamp(vertex[1], -1.0f, 1.0f) * 511.0f);
+        z = Round(Clamp(vertex[2], -1.0f, 1.0f) * 511.0f);
+        w = components == 4 ? Round(Clamp(vertex[3], -1.0f, 1.0f)) : 0;
+#endif
+        //Two's complement fields, x in the lowest bits
+        destination[i] = ((uint32_t)x & 0x3ff) | (((uint32_t)y & 0x3ff) << 10) | (((uint32_t)z & 0x3ff) << 20) | (((uint32_t)w & 0x3) << 30);
+    }
+}
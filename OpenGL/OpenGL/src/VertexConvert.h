@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+
+//Quantizes float attribute streams into the compact vertex formats VertexBufferLayout can describe.
+//Each call converts count floats (count vertices for the packed format) from a tightly packed array.
+//SSE2 does four values at a time where the compiler targets it, the scalar path gives the same results.
+class VertexConvert
+{
+public:
+	//IEEE half, round to nearest even. Exact for integers up to 2048, about 3 significant digits otherwise.
+	static void FloatToHalf(uint16_t* destination, const float* source, unsigned int count);
+	//Clamped to [-1, 1], for GL_SHORT normalized
+	static void FloatToSnorm16(int16_t* destination, const float* source, unsigned int count);
+	//Clamped to [0, 1], for GL_UNSIGNED_SHORT normalized (texture coordinates in [0, 1])
+	static void FloatToUnorm16(uint16_t* destination, const float* source, unsigned int count);
+	//Clamped to [0, 1], for GL_UNSIGNED_BYTE normalized (colours)
+	static void FloatToUnorm8(uint8_t* destination, const float* source, unsigned int count);
+	//components floats per vertex (3 or 4, w = 0 for 3) into GL_INT_2_10_10_10_REV, each clamped to [-1, 1]
+	static void PackSnorm10_10_10_2(uint32_t* destination, const float* source, unsigned int count, unsigned int components);
+
+	static uint16_t FloatToHalf(float value);
+};
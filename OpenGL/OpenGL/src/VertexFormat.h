@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <GL/glew.h>
+#include "glm/glm.hpp"
+
+//Compile-time vertex layouts, the static counterpart of VertexBufferLayout. Declare the members of a vertex
+//struct once, at namespace scope after the struct:
+//
+//	struct MeshVertex { glm::vec3 Position; glm::vec2 TexCoord; uint16_t Normal[2]; };
+//	VERTEX_FORMAT(MeshVertex,
+//		VERTEX_ATTRIBUTE(MeshVertex, Position),
+//		VERTEX_ATTRIBUTE(MeshVertex, TexCoord),
+//		VERTEX_ATTRIBUTE_AS(MeshVertex, Normal, VertexAttributeFormat<GL_SHORT, 2, true>))
+//
+//and set it up with va.AddBuffer<MeshVertex>(vb). Offsets and stride are worked out from the attribute sizes
+//and static_assert'ed against offsetof/sizeof, so a reordered, padded or forgotten member fails to compile.
+//Nothing is allocated and the attribute setup is one fixed call per member.
+
+struct VertexAttribute
+{
+	unsigned int type;
+	unsigned int count;
+	unsigned char normalized;
+	unsigned char integer; //Read as int/uint in the shader (glVertexAttribIPointer)
+	unsigned int offset; //offsetof the member
+	unsigned int memberSize; //sizeof the member
+
+	static constexpr unsigned int GetSizeofType(unsigned int type)
+	{
+		return type == GL_FLOAT || type == GL_INT || type == GL_UNSIGNED_INT ? 4
+			: type == GL_HALF_FLOAT || type == GL_SHORT || type == GL_UNSIGNED_SHORT ? 2
+			: type == GL_BYTE || type == GL_UNSIGNED_BYTE ? 1
+			: type == GL_INT_2_10_10_10_REV ? 4 //All four components together
+			: 0;
+	}
+
+	constexpr unsigned int GetSize() const { return type == GL_INT_2_10_10_10_REV ? 4 : count * GetSizeofType(type); }
+};
+
+template<unsigned int Type, unsigned int Count, bool Normalized = false, bool Integer = false>
+struct VertexAttributeFormat
+{
+	static constexpr VertexAttribute At(unsigned int offset, unsigned int memberSize)
+	{
+		return { Type, Count, Normalized, Integer, offset, memberSize };
+	}
+};
+
+//Formats VERTEX_ATTRIBUTE picks from the member's type. Anything else (halfs, packed normals) goes through VERTEX_ATTRIBUTE_AS.
+template<typename T> struct VertexAttributeTraits;
+template<> struct VertexAttributeTraits<float> : VertexAttributeFormat<GL_FLOAT, 1> {};
+template<> struct VertexAttributeTraits<glm::vec2> : VertexAttributeFormat<GL_FLOAT, 2> {};
+template<> struct VertexAttributeTraits<glm::vec3> : VertexAttributeFormat<GL_FLOAT, 3> {};
+template<> struct VertexAttributeTraits<glm::vec4> : VertexAttributeFormat<GL_FLOAT, 4> {};
+template<> struct VertexAttributeTraits<int> : VertexAttributeFormat<GL_INT, 1, false, true> {};
+template<> struct VertexAttributeTraits<glm::ivec2> : VertexAttributeFormat<GL_INT, 2, false, true> {};
+template<> struct VertexAttributeTraits<glm::ivec3> : VertexAttributeFormat<GL_INT, 3, false, true> {};
+template<> struct VertexAttributeTraits<glm::ivec4> : VertexAttributeFormat<GL_INT, 4, false, true> {};
+template<> struct VertexAttributeTraits<unsigned int> : VertexAttributeFormat<GL_UNSIGNED_INT, 1, false, true> {};
+template<> struct VertexAttributeTraits<glm::uvec2> : VertexAttributeFormat<GL_UNSIGNED_INT, 2, false, true> {};
+template<> struct VertexAttributeTraits<glm::uvec3> : VertexAttributeFormat<GL_UNSIGNED_INT, 3, false, true> {};
+template<> struct VertexAttributeTraits<glm::uvec4> : VertexAttributeFormat<GL_UNSIGNED_INT, 4, false, true> {};
+//Normalized like VertexBufferLayout's Push<unsigned char>/Push<short>/Push<unsigned short>
+template<> struct VertexAttributeTraits<glm::u8vec4> : VertexAttributeFormat<GL_UNSIGNED_BYTE, 4, true> {};
+template<> struct VertexAttributeTraits<glm::i16vec2> : VertexAttributeFormat<GL_SHORT, 2, true> {};
+template<> struct VertexAttributeTraits<glm::i16vec4> : VertexAttributeFormat<GL_SHORT, 4, true> {};
+template<> struct VertexAttributeTraits<glm::u16vec2> : VertexAttributeFormat<GL_UNSIGNED_SHORT, 2, true> {};
+template<> struct VertexAttributeTraits<glm::u16vec4> : VertexAttributeFormat<GL_UNSIGNED_SHORT, 4, true> {};
+
+//Specialized by VERTEX_FORMAT: Count, and Get(i) for the i-th attribute in declaration order
+template<typename Vertex> struct VertexFormat;
+
+template<typename... Attributes>
+constexpr unsigned int CountVertexAttributes(const Attributes&...) { return sizeof...(Attributes); }
+
+template<typename Vertex>
+struct VertexLayout
+{
+	static constexpr unsigned int Count = VertexFormat<Vertex>::Count;
+	static constexpr unsigned int Stride = sizeof(Vertex);
+
+	//Where attribute i goes when the attributes are laid out back to back, in order
+	static constexpr unsigned int Offset(unsigned int i)
+	{
+		unsigned int offset = 0;
+		for (unsigned int j = 0; j < i; j++)
+			offset += VertexFormat<Vertex>::Get(j).GetSize();
+		return offset;
+	}
+
+	static constexpr bool SizesMatch()
+	{
+		for (unsigned int i = 0; i < Count; i++)
+		{
+			if (VertexFormat<Vertex>::Get(i).GetSize() != VertexFormat<Vertex>::Get(i).memberSize)
+				return false;
+		}
+		return true;
+	}
+
+	static constexpr bool OffsetsMatch()
+	{
+		for (unsigned int i = 0; i < Count; i++)
+		{
+			if (Offset(i) != VertexFormat<Vertex>::Get(i).offset)
+				return false;
+		}
+		return true;
+	}
+};
+
+#define VERTEX_ATTRIBUTE(Vertex, member) \
+	VertexAttributeTraits<decltype(Vertex::member)>::At((unsigned int)offsetof(Vertex, member), (unsigned int)sizeof(Vertex::member))
+//The last argument is a VertexAttributeFormat<...>, commas and all
+#define VERTEX_ATTRIBUTE_AS(Vertex, member, ...) \
+	__VA_ARGS__::At((unsigned int)offsetof(Vertex, member), (unsigned int)sizeof(Vertex::member))
+
+#define VERTEX_FORMAT(Vertex, ...) \
+	template<> struct VertexFormat<Vertex> \
+	{ \
+		static constexpr unsigned int Count = CountVertexAttributes(__VA_ARGS__); \
+		static constexpr VertexAttribute Get(unsigned int i) \
+		{ \
+			const VertexAttribute attributes[] = { __VA_ARGS__ }; \
+			return attributes[i]; \
+		} \
+	}; \
+	static_assert(VertexLayout<Vertex>::SizesMatch(), #Vertex ": a member's size doesn't match its attribute format"); \
+	static_assert(VertexLayout<Vertex>::OffsetsMatch(), #Vertex ": members are out of order or padded, or one is missing from its VERTEX_FORMAT"); \
+	static_assert(VertexLayout<Vertex>::Offset(VertexLayout<Vertex>::Count) == sizeof(Vertex), #Vertex ": members after the last attribute, or padding at the end");
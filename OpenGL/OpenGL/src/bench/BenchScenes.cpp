@@ -0,0 +1,729 @@
+#include "BenchScenes.h"
+#include <iostream>
+#include <cmath>
+#include "Renderer.h"
+#include "GLStateCache.h"
+#include "VertexBuffer.h"
+#include "VertexBufferLayout.h"
+#include "IndexBuffer.h"
+#include "VertexArray.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "BatchRenderer2D.h"
+#include "IndirectDrawList.h"
+#include "CommandRecorder.h"
+#include "GeometryPool.h"
+#include "VertexArrayCache.h"
+#include "MeshOptimizer.h"
+#include "VertexConvert.h"
+#include "UniformBuffer.h"
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+static const unsigned int s_QuadIndices[] = { 0,1,2, 2,3,0 };
+static const unsigned int s_WhitePixel = 0xffffffff;
+static constexpr UniformID s_MVP("u_MVP"); //Set per object in the hot loops, hashed once here
+
+//What the float vertex arrays below hold, 4 floats a vertex
+struct TexturedVertex
+{
+    glm::vec2 Position;
+    glm::vec2 TexCoord;
+};
+
+VERTEX_FORMAT(TexturedVertex,
+    VERTEX_ATTRIBUTE(TexturedVertex, Position),
+    VERTEX_ATTRIBUTE(TexturedVertex, TexCoord))
+
+//Position and texture coordinates of a size x size quad
+static std::vector<float> QuadVertices(float size)
+{
+    return {
+        0.0f, 0.0f, 0.0f, 0.0f,
+        size, 0.0f, 1.0f, 0.0f,
+        size, size, 1.0f, 1.0f,
+        0.0f, size, 0.0f, 1.0f
+    };
+}
+
+//Spread over the framebuffer without any randomness, so every run draws the same frame
+static glm::vec2 ObjectPosition(unsigned int i, const SceneParams& params, float size)
+{
+    return glm::vec2((float)((i * 37) % (params.Width - (int)size)), (float)((i * 91) % (params.Height - (int)size)));
+}
+
+static glm::mat4 Projection(const SceneParams& params)
+{
+    return glm::ortho(0.0f, (float)params.Width, 0.0f, (float)params.Height, -1.0f, 1.0f);
+}
+
+//1x1 textures of different colours
+static std::vector<std::unique_ptr<Texture>> CreateTextures(unsigned int count)
+{
+    std::vector<std::unique_ptr<Texture>> textures;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        unsigned int pixel = 0xff000000 | (i * 0x3b1f97);
+        textures.emplace_back(new Texture(1, 1, &pixel));
+    }
+    return textures;
+}
+
+//One textured quad mesh shared by the scenes that draw quads one by one
+class QuadMesh
+{
+public:
+    std::vector<float> Vertices;
+    VertexArray VA;
+    VertexBuffer VB;
+    IndexBuffer IB;
+
+    QuadMesh(float size)
+        :Vertices(QuadVertices(size)), VB(Vertices.data(), (unsigned int)(Vertices.size() * sizeof(float))), IB(s_QuadIndices, 6)
+    {
+        VA.AddBuffer<TexturedVertex>(VB);
+    }
+};
+
+//The way Sandbox draws its quad: a texture bind, an MVP upload and a glDrawElements per quad
+class PerQuadScene : public BenchScene
+{
+private:
+    SceneParams m_Params;
+    Renderer m_Renderer;
+    QuadMesh m_Quad;
+    Shader m_Shader;
+    std::vector<std::unique_ptr<Texture>> m_Textures;
+public:
+    PerQuadScene(const SceneParams& params)
+        :m_Params(params), m_Quad(8.0f), m_Shader("resources/shaders/Basic.shader"), m_Textures(CreateTextures(params.Textures))
+    {
+        m_Shader.Bind();
+        m_Shader.setUniform1i("u_Texture", 0);
+    }
+
+    void Render() override
+    {
+        GLCall(glClear(GL_COLOR_BUFFER_BIT));
+        glm::mat4 proj = Projection(m_Params);
+        for (unsigned int i = 0; i < m_Params.Objects; i++)
+        {
+            m_Textures[i % m_Textures.size()]->Bind();
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(ObjectPosition(i, m_Params, 8.0f), 0.0f));
+            m_Shader.setUniformMat4f(s_MVP, proj * model);
+            m_Renderer.Draw(m_Quad.VA, m_Quad.IB, m_Shader);
+        }
+    }
+};
+
+class BatchedScene : public BenchScene
+{
+private:
+    SceneParams m_Params;
+    Renderer m_Renderer;
+    BatchRenderer2D m_Batch;
+    std::vector<std::unique_ptr<Texture>> m_Textures;
+public:
+    BatchedScene(const SceneParams& params)
+        :m_Params(params), m_Batch(m_Renderer), m_Textures(CreateTextures(params.Textures))
+    {
+    }
+
+    void Render() override
+    {
+        GLCall(glClear(GL_COLOR_BUFFER_BIT));
+        m_Batch.BeginBatch(Projection(m_Params));
+        for (unsigned int i = 0; i < m_Params.Objects; i++)
+            m_Batch.DrawQuad(ObjectPosition(i, m_Params, 8.0f), glm::vec2(8.0f), *m_Textures[i % m_Textures.size()]);
+        m_Batch.EndBatch();
+    }
+};
+
+class InstancedScene : public BenchScene
+{
+private:
+    struct InstanceData
+    {
+        glm::mat4 Model;
+        glm::vec4 Color;
+    };
+
+    SceneParams m_Params;
+    Renderer m_Renderer;
+    QuadMesh m_Quad;
+    std::vector<InstanceData> m_InstanceData;
+    VertexBuffer m_InstanceBuffer;
+    VertexArray m_VA;
+    Shader m_Shader;
+    Texture m_White;
+public:
+    InstancedScene(const SceneParams& params)
+        :m_Params(params), m_Quad(2.0f), m_InstanceData(BuildInstances(params)),
+        m_InstanceBuffer(m_InstanceData.data(), (unsigned int)(m_InstanceData.size() * sizeof(InstanceData))),
+        m_Shader("resources/shaders/Instanced.shader"), m_White(1, 1, &s_WhitePixel)
+    {
+        VertexBufferLayout layout;
+        layout.Push<float>(2);
+        layout.Push<float>(2);
+        VertexBufferLayout instanceLayout;
+        instanceLayout.Push<float>(4, 1); //Model matrix, one column per attribute
+        instanceLayout.Push<float>(4, 1);
+        instanceLayout.Push<float>(4, 1);
+        instanceLayout.Push<float>(4, 1);
+        instanceLayout.Push<float>(4, 1); //Color
+        m_VA.AddBuffer(m_Quad.VB, layout);
+        m_VA.AddBuffer(m_InstanceBuffer, instanceLayout);
+
+        m_Shader.Bind();
+        m_Shader.setUniform1i("u_Texture", 0);
+        m_Shader.setUniformMat4f("u_ViewProj", Projection(params));
+    }
+
+    void Render() override
+    {
+        GLCall(glClear(GL_COLOR_BUFFER_BIT));
+        m_White.Bind();
+        m_Renderer.DrawInstanced(m_VA, m_Quad.IB, m_Shader, m_Params.Objects);
+    }
+private:
+    static std::vector<InstanceData> BuildInstances(const SceneParams& params)
+    {
+        std::vector<InstanceData> instances(params.Objects);
+        for (unsigned int i = 0; i < params.Objects; i++)
+        {
+            instances[i].Model = glm::translate(glm::mat4(1.0f), glm::vec3(ObjectPosition(i, params, 2.0f), 0.0f));
+            instances[i].Color = glm::vec4((i % 7) / 7.0f, (i % 5) / 5.0f, (i % 3) / 3.0f, 1.0f);
+        }
+        return instances;
+    }
+};
+
+//Regular polygons with 3, 4, 5... sides in one vertex/index array, drawn through an IndirectDrawList
+class IndirectScene : public BenchScene
+{
+private:
+    SceneParams m_Params;
+    Renderer m_Renderer;
+    std::vector<float> m_Vertices;
+    std::vector<unsigned int> m_Indices;
+    IndirectDrawList m_List;
+    VertexArray m_VA;
+    VertexBuffer m_VB;
+    IndexBuffer m_IB;
+    Shader m_Shader;
+    unsigned int m_DataBuffer, m_DataTexture;
+public:
+    IndirectScene(const SceneParams& params, bool multiDraw)
+        :m_Params(params), m_List(BuildShapes(params, m_Vertices, m_Indices)),
+        m_VB(m_Vertices.data(), (unsigned int)(m_Vertices.size() * sizeof(float))),
+        m_IB(m_Indices.data(), (unsigned int)m_Indices.size()), m_Shader("resources/shaders/MultiDraw.shader")
+    {
+        unsigned int sides = 3;
+        unsigned int firstIndex = 0;
+        int baseVertex = 0;
+        std::vector<unsigned int> firstIndices;
+        std::vector<int> baseVertices;
+        for (unsigned int shape = 0; shape < params.Shapes; shape++, sides++)
+        {
+            firstIndices.push_back(firstIndex);
+            baseVertices.push_back(baseVertex);
+            firstIndex += (sides - 2) * 3;
+            baseVertex += sides;
+        }
+        for (unsigned int i = 0; i < params.Objects; i++)
+        {
+            unsigned int shape = i % params.Shapes;
+            m_List.Add((shape + 1) * 3, firstIndices[shape], baseVertices[shape]);
+        }
+        m_List.SetMultiDrawEnabled(multiDraw);
+
+        VertexBufferLayout layout;
+        layout.Push<float>(2);
+        m_VA.AddBuffer(m_VB, layout);
+        VertexBufferLayout drawIDLayout;
+        drawIDLayout.Push<float>(1, 1);
+        m_VA.AddBuffer(m_List.GetDrawIDBuffer(), drawIDLayout);
+
+        //Per-draw model matrix and colour in a texture buffer, 5 texels per draw
+        std::vector<glm::vec4> drawData;
+        drawData.reserve(params.Objects * 5);
+        for (unsigned int i = 0; i < params.Objects; i++)
+        {
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(ObjectPosition(i, params, 4.0f), 0.0f));
+            for (int column = 0; column < 4; column++)
+                drawData.push_back(model[column]);
+            drawData.push_back(glm::vec4((i % 7) / 7.0f, (i % 5) / 5.0f, (i % 3) / 3.0f, 1.0f));
+        }
+        GLCall(glGenBuffers(1, &m_DataBuffer));
+        GLStateCache::Get().BindBuffer(GL_TEXTURE_BUFFER, m_DataBuffer);
+        GLCall(glBufferData(GL_TEXTURE_BUFFER, drawData.size() * sizeof(glm::vec4), drawData.data(), GL_STATIC_DRAW));
+        GLCall(glGenTextures(1, &m_DataTexture));
+        GLStateCache::Get().ActiveTexture(1);
+        GLCall(glBindTexture(GL_TEXTURE_BUFFER, m_DataTexture));
+        GLCall(glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, m_DataBuffer));
+
+        m_Shader.Bind();
+        m_Shader.setUniform1i("u_DrawData", 1);
+        m_Shader.setUniformMat4f("u_ViewProj", Projection(params));
+    }
+
+    ~IndirectScene()
+    {
+        GLCall(glDeleteTextures(1, &m_DataTexture));
+        GLCall(glDeleteBuffers(1, &m_DataBuffer));
+        GLStateCache::Get().OnDeleteBuffer(m_DataBuffer);
+    }
+
+    void Render() override
+    {
+        GLCall(glClear(GL_COLOR_BUFFER_BIT));
+        m_Renderer.DrawIndirect(m_VA, m_IB, m_Shader, m_List, 1);
+    }
+private:
+    //Fills the arrays before the buffers are created from them, returns the list capacity
+    static unsigned int BuildShapes(const SceneParams& params, std::vector<float>& vertices, std::vector<unsigned int>& indices)
+    {
+        for (unsigned int shape = 0; shape < params.Shapes; shape++)
+        {
+            unsigned int sides = 3 + shape;
+            for (unsigned int i = 0; i < sides; i++)
+            {
+                float angle = 6.2831853f * i / sides;
+                vertices.push_back(2.0f * cosf(angle));
+                vertices.push_back(2.0f * sinf(angle));
+            }
+            for (unsigned int i = 1; i + 1 < sides; i++)
+            {
+                indices.push_back(0);
+                indices.push_back(i);
+                indices.push_back(i + 1);
+            }
+        }
+        return params.Objects;
+    }
+};
+
+//Packets submitted in an order that interleaves programs and textures, the queue sorts them back
+class QueueScene : public BenchScene
+{
+private:
+    SceneParams m_Params;
+    Renderer m_Renderer;
+    QuadMesh m_Quad;
+    std::vector<std::unique_ptr<Shader>> m_Shaders;
+    std::vector<std::unique_ptr<Texture>> m_Textures;
+public:
+    QueueScene(const SceneParams& params)
+        :m_Params(params), m_Quad(8.0f), m_Textures(CreateTextures(params.Textures))
+    {
+        //Separate programs from the same source, enough to make program switches count
+        for (unsigned int i = 0; i < params.Shaders; i++)
+        {
+            m_Shaders.emplace_back(new Shader("resources/shaders/Basic.shader"));
+            m_Shaders.back()->Bind();
+            m_Shaders.back()->setUniform1i("u_Texture", 0);
+        }
+    }
+
+    void Render() override
+    {
+        GLCall(glClear(GL_COLOR_BUFFER_BIT));
+        glm::mat4 proj = Projection(m_Params);
+        for (unsigned int i = 0; i < m_Params.Objects; i++)
+        {
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(ObjectPosition(i, m_Params, 8.0f), 0.0f));
+            m_Renderer.Submit(m_Quad.VA, m_Quad.IB, *m_Shaders[i % m_Shaders.size()], m_Textures[(i / m_Shaders.size()) % m_Textures.size()].get(),
+                proj * model, (float)((i * 2654435761u) & 0xffff) / 65535.0f);
+        }
+        m_Renderer.Execute();
+    }
+};
+
+//Same draws as PerQuadScene, recorded into command lists on worker threads and replayed
+class RecordedScene : public BenchScene
+{
+private:
+    SceneParams m_Params;
+    Renderer m_Renderer;
+    QuadMesh m_Quad;
+    Shader m_Shader;
+    std::vector<std::unique_ptr<Texture>> m_Textures;
+    CommandRecorder m_Recorder;
+public:
+    RecordedScene(const SceneParams& params)
+        :m_Params(params), m_Quad(8.0f), m_Shader("resources/shaders/Basic.shader"), m_Textures(CreateTextures(params.Textures))
+    {
+        m_Shader.Bind();
+        m_Shader.setUniform1i("u_Texture", 0);
+    }
+
+    void Render() override
+    {
+        glm::mat4 proj = Projection(m_Params);
+        m_Recorder.Record(m_Params.Objects, [&](CommandList& list, unsigned int begin, unsigned int end)
+        {
+            for (unsigned int i = begin; i < end; i++)
+            {
+                glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(ObjectPosition(i, m_Params, 8.0f), 0.0f));
+                list.SetUniformMat4f(s_MVP, proj * model);
+                list.Draw(m_Quad.VA, m_Quad.IB, m_Shader, m_Textures[i % m_Textures.size()].get());
+            }
+        });
+
+        GLCall(glClear(GL_COLOR_BUFFER_BIT));
+        m_Recorder.Replay(m_Renderer);
+    }
+};
+
+//params.Shapes different small meshes, each drawn with its own MVP. Separate: a vertex array and buffers per mesh,
+//so most draws switch vertex arrays. Pooled: every mesh in one GeometryPool, one vertex array for the whole scene.
+//Streams: positions and texture coordinates in two buffers per mesh, drawn on the one vertex array VertexArrayCache
+//keeps for the format. Its buffers are swapped with glBindVertexBuffer, or re-pointed for StreamsPointers.
+class MeshesScene : public BenchScene
+{
+public:
+    enum class Mode { Separate, Pooled, Streams, StreamsPointers };
+private:
+    struct SeparateMesh
+    {
+        VertexArray VA;
+        VertexBuffer VB;
+        IndexBuffer IB;
+
+        SeparateMesh(const std::vector<float>& vertices, const std::vector<unsigned int>& indices)
+            :VB(vertices.data(), (unsigned int)(vertices.size() * sizeof(float))), IB(indices.data(), (unsigned int)indices.size())
+        {
+            VA.AddBuffer<TexturedVertex>(VB);
+        }
+    };
+
+    SceneParams m_Params;
+    Renderer m_Renderer;
+    Shader m_Shader;
+    std::vector<std::unique_ptr<Texture>> m_Textures;
+    std::vector<std::unique_ptr<SeparateMesh>> m_Separate;
+    std::unique_ptr<GeometryPool> m_Pool;
+    std::vector<unsigned int> m_PoolMeshes;
+    VertexStreamLayout m_StreamLayout;
+    std::vector<std::unique_ptr<VertexBuffer>> m_StreamBuffers; //Positions and texture coordinates of each mesh, in turn
+    std::vector<std::unique_ptr<IndexBuffer>> m_StreamIndices;
+public:
+    MeshesScene(const SceneParams& params, Mode mode)
+        :m_Params(params), m_Shader("resources/shaders/Basic.shader"), m_Textures(CreateTextures(1))
+    {
+        VertexBufferLayout layout;
+        layout.Push<float>(2);
+        layout.Push<float>(2);
+
+        std::vector<std::vector<float>> vertices(params.Shapes);
+        std::vector<std::vector<unsigned int>> indices(params.Shapes);
+        unsigned int vertexCount = 0, indexCount = 0;
+        for (unsigned int shape = 0; shape < params.Shapes; shape++)
+        {
+            unsigned int sides = 3 + shape;
+            for (unsigned int i = 0; i < sides; i++)
+            {
+                float angle = 6.2831853f * i / sides;
+                vertices[shape].insert(vertices[shape].end(), { 4.0f + 4.0f * cosf(angle), 4.0f + 4.0f * sinf(angle), 0.5f, 0.5f });
+            }
+            for (unsigned int i = 1; i + 1 < sides; i++)
+                indices[shape].insert(indices[shape].end(), { 0, i, i + 1 });
+            vertexCount += sides;
+            indexCount += (unsigned int)indices[shape].size();
+        }
+
+        if (mode == Mode::Pooled)
+        {
+            m_Pool.reset(new GeometryPool(layout, vertexCount, indexCount));
+            for (unsigned int shape = 0; shape < params.Shapes; shape++)
+                m_PoolMeshes.push_back(m_Pool->AddMesh(vertices[shape].data(), (unsigned int)vertices[shape].size() / 4, indices[shape].data(), (unsigned int)indices[shape].size()));
+        }
+        else if (mode == Mode::Separate)
+        {
+            for (unsigned int shape = 0; shape < params.Shapes; shape++)
+                m_Separate.emplace_back(new SeparateMesh(vertices[shape], indices[shape]));
+        }
+        else
+        {
+            VertexArrayCache::Get().SetAttribBindingEnabled(mode == Mode::Streams);
+            VertexBufferLayout positionLayout, texCoordLayout;
+            positionLayout.Push<float>(2);
+            texCoordLayout.Push<float>(2);
+            m_StreamLayout.AddStream(positionLayout);
+            m_StreamLayout.AddStream(texCoordLayout);
+            for (unsigned int shape = 0; shape < params.Shapes; shape++)
+            {
+                std::vector<float> positions, texCoords;
+                for (size_t i = 0; i < vertices[shape].size(); i += 4)
+                {
+                    positions.insert(positions.end(), { vertices[shape][i], vertices[shape][i + 1] });
+                    texCoords.insert(texCoords.end(), { vertices[shape][i + 2], vertices[shape][i + 3] });
+                }
+                m_StreamBuffers.emplace_back(new VertexBuffer(positions.data(), (unsigned int)(positions.size() * sizeof(float))));
+                m_StreamBuffers.emplace_back(new VertexBuffer(texCoords.data(), (unsigned int)(texCoords.size() * sizeof(float))));
+                m_StreamIndices.emplace_back(new IndexBuffer(indices[shape].data(), (unsigned int)indices[shape].size()));
+            }
+        }
+
+        m_Shader.Bind();
+        m_Shader.setUniform1i("u_Texture", 0);
+    }
+
+    void Render() override
+    {
+        GLCall(glClear(GL_COLOR_BUFFER_BIT));
+        glm::mat4 proj = Projection(m_Params);
+        m_Textures[0]->Bind();
+        for (unsigned int i = 0; i < m_Params.Objects; i++)
+        {
+            unsigned int shape = i % m_Params.Shapes;
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(ObjectPosition(i, m_Params, 8.0f), 0.0f));
+            m_Shader.setUniformMat4f(s_MVP, proj * model);
+            if (m_Pool)
+                m_Renderer.DrawMesh(*m_Pool, m_PoolMeshes[shape], m_Shader);
+            else if (!m_Separate.empty())
+                m_Renderer.Draw(m_Separate[shape]->VA, m_Separate[shape]->IB, m_Shader);
+            else
+            {
+                const VertexBuffer* streams[] = { m_StreamBuffers[shape * 2].get(), m_StreamBuffers[shape * 2 + 1].get() };
+                m_Renderer.Draw(m_StreamLayout, streams, *m_StreamIndices[shape], m_Shader);
+            }
+        }
+    }
+};
+
+//One dense grid mesh with its triangles in shuffled order, the way some exporters leave them, drawn
+//params.Objects / 1000 times. Optimized runs it through MeshOptimizer's vertex cache and fetch passes first.
+//Tiny triangles keep the frame bound by vertex work. Overdraw ordering is left out, the scene is flat.
+//Compact stores the optimized mesh as half float positions and 16-bit texture coordinates, 8 bytes a vertex instead of 16.
+class GridMeshScene : public BenchScene
+{
+private:
+    static const unsigned int GridSize = 200; //Cells per side, 40401 vertices
+    SceneParams m_Params;
+    Renderer m_Renderer;
+    std::vector<unsigned int> m_Indices; //Before m_Vertices, BuildGrid fills it
+    std::vector<unsigned char> m_Vertices;
+    VertexArray m_VA;
+    VertexBuffer m_VB;
+    IndexBuffer m_IB;
+    Shader m_Shader;
+    Texture m_White;
+public:
+    GridMeshScene(const SceneParams& params, bool optimized, bool compact)
+        :m_Params(params), m_Vertices(Encode(BuildGrid(m_Indices, optimized || compact), compact)),
+        m_VB(m_Vertices.data(), (unsigned int)m_Vertices.size()), m_IB(m_Indices.data(), (unsigned int)m_Indices.size()),
+        m_Shader("resources/shaders/Basic.shader"), m_White(1, 1, &s_WhitePixel)
+    {
+        VertexBufferLayout layout;
+        if (compact)
+        {
+            layout.PushHalf(2);
+            layout.Push<unsigned short>(2);
+        }
+        else
+        {
+            layout.Push<float>(2);
+            layout.Push<float>(2);
+        }
+        m_VA.AddBuffer(m_VB, layout);
+        m_Shader.Bind();
+        m_Shader.setUniform1i("u_Texture", 0);
+    }
+
+    void Render() override
+    {
+        GLCall(glClear(GL_COLOR_BUFFER_BIT));
+        glm::mat4 proj = Projection(m_Params);
+        m_White.Bind();
+        for (unsigned int i = 0; i < std::max(m_Params.Objects / 1000, 1u); i++)
+        {
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(ObjectPosition(i, m_Params, (float)GridSize), 0.0f));
+            m_Shader.setUniformMat4f(s_MVP, proj * model);
+            m_Renderer.Draw(m_VA, m_IB, m_Shader);
+        }
+    }
+private:
+    //One pixel per cell, position and texture coordinates per vertex
+    static std::vector<float> BuildGrid(std::vector<unsigned int>& indices, bool optimized)
+    {
+        std::vector<float> vertices;
+        for (unsigned int y = 0; y <= GridSize; y++)
+        {
+            for (unsigned int x = 0; x <= GridSize; x++)
+                vertices.insert(vertices.end(), { (float)x, (float)y, (float)x / GridSize, (float)y / GridSize });
+        }
+        std::vector<unsigned int> cells(GridSize * GridSize);
+        for (unsigned int i = 0; i < cells.size(); i++)
+            cells[i] = i;
+        //Fixed seed, every run gets the same order
+        unsigned int seed = 12345;
+        for (unsigned int i = (unsigned int)cells.size() - 1; i > 0; i--)
+        {
+            seed = seed * 1664525 + 1013904223;
+            std::swap(cells[i], cells[seed % (i + 1)]);
+        }
+        for (unsigned int cell : cells)
+        {
+            unsigned int corner = cell / GridSize * (GridSize + 1) + cell % GridSize;
+            indices.insert(indices.end(), { corner, corner + 1, corner + GridSize + 2, corner + GridSize + 2, corner + GridSize + 1, corner });
+        }
+
+        unsigned int vertexCount = (unsigned int)vertices.size() / 4;
+        MeshOptimizer::CacheStats before = MeshOptimizer::AnalyzeVertexCache(indices.data(), (unsigned int)indices.size(), vertexCount);
+        if (optimized)
+        {
+            MeshOptimizer::OptimizeVertexCache(indices.data(), indices.data(), (unsigned int)indices.size(), vertexCount);
+            std::vector<float> fetchOrdered(vertices.size());
+            MeshOptimizer::OptimizeVertexFetch(fetchOrdered.data(), indices.data(), (unsigned int)indices.size(), vertices.data(), vertexCount, 4 * sizeof(float));
+            vertices.swap(fetchOrdered);
+            MeshOptimizer::CacheStats after = MeshOptimizer::AnalyzeVertexCache(indices.data(), (unsigned int)indices.size(), vertexCount);
+            std::cout << "[Bench] Grid mesh ACMR " << before.ACMR << " -> " << after.ACMR << ", ATVR " << before.ATVR << " -> " << after.ATVR << std::endl;
+        }
+        else
+            std::cout << "[Bench] Grid mesh ACMR " << before.ACMR << ", ATVR " << before.ATVR << std::endl;
+        return vertices;
+    }
+
+    static std::vector<unsigned char> Encode(const std::vector<float>& vertices, bool compact)
+    {
+        if (!compact)
+            return std::vector<unsigned char>((const unsigned char*)vertices.data(), (const unsigned char*)(vertices.data() + vertices.size()));
+
+        unsigned int vertexCount = (unsigned int)vertices.size() / 4;
+        std::vector<float> positions, texCoords;
+        for (unsigned int i = 0; i < vertexCount; i++)
+        {
+            positions.insert(positions.end(), { vertices[i * 4], vertices[i * 4 + 1] });
+            texCoords.insert(texCoords.end(), { vertices[i * 4 + 2], vertices[i * 4 + 3] });
+        }
+        std::vector<uint16_t> halfPositions(positions.size()), unormTexCoords(texCoords.size());
+        VertexConvert::FloatToHalf(halfPositions.data(), positions.data(), (unsigned int)positions.size());
+        VertexConvert::FloatToUnorm16(unormTexCoords.data(), texCoords.data(), (unsigned int)texCoords.size());
+
+        std::vector<uint16_t> interleaved;
+        for (unsigned int i = 0; i < vertexCount; i++)
+            interleaved.insert(interleaved.end(), { halfPositions[i * 2], halfPositions[i * 2 + 1], unormTexCoords[i * 2], unormTexCoords[i * 2 + 1] });
+        return std::vector<unsigned char>((const unsigned char*)interleaved.data(), (const unsigned char*)(interleaved.data() + interleaved.size()));
+    }
+};
+
+//Per-quad drawing with the camera and model matrix in uniform blocks instead of an MVP upload per draw: the Frame
+//block is written once for every program, the Object blocks of all quads in one allocation, and each draw only
+//binds its range. Programs are copies of the same source, drawn one after the other
+class UniformBlocksScene : public BenchScene
+{
+private:
+    SceneParams m_Params;
+    Renderer m_Renderer;
+    QuadMesh m_Quad;
+    std::vector<std::unique_ptr<Shader>> m_Shaders;
+    std::vector<std::unique_ptr<Texture>> m_Textures;
+    UniformBuffer m_Uniforms;
+    std::vector<ObjectUniforms> m_Objects;
+public:
+    UniformBlocksScene(const SceneParams& params)
+        :m_Params(params), m_Quad(8.0f), m_Textures(CreateTextures(params.Textures)),
+        m_Uniforms(3 * (params.Objects + 1) * 256), //Three frames at the largest offset alignment drivers ask for
+        m_Objects(params.Objects)
+    {
+        for (unsigned int i = 0; i < params.Shaders; i++)
+        {
+            m_Shaders.emplace_back(new Shader("resources/shaders/Blocks.shader"));
+            m_Shaders.back()->Bind();
+            m_Shaders.back()->setUniform1i("u_Texture", 0);
+        }
+    }
+
+    void Render() override
+    {
+        GLCall(glClear(GL_COLOR_BUFFER_BIT));
+        FrameUniforms frame;
+        frame.Projection = Projection(m_Params);
+        frame.View = glm::mat4(1.0f);
+        frame.ViewProjection = frame.Projection * frame.View;
+        frame.CameraPosition = glm::vec3(0.0f);
+        frame.Time = 0.0f;
+        m_Uniforms.Set(frame);
+
+        for (unsigned int i = 0; i < m_Params.Objects; i++)
+        {
+            m_Objects[i].Model = glm::translate(glm::mat4(1.0f), glm::vec3(ObjectPosition(i, m_Params, 8.0f), 0.0f));
+            m_Objects[i].Color = glm::vec4(1.0f);
+        }
+        UniformBuffer::Range objects = m_Uniforms.Write(m_Objects.data(), m_Params.Objects);
+
+        for (unsigned int i = 0; i < objects.Count; i++)
+        {
+            m_Textures[i % m_Textures.size()]->Bind();
+            m_Uniforms.Bind<ObjectUniforms>(objects, i);
+            m_Renderer.Draw(m_Quad.VA, m_Quad.IB, *m_Shaders[(unsigned long long)i * m_Shaders.size() / m_Params.Objects]);
+        }
+        m_Uniforms.EndFrame();
+    }
+};
+
+const std::vector<std::string>& GetBenchSceneNames()
+{
+    static const std::vector<std::string> names = { "per-quad", "batched", "batched-50k", "instanced", "indirect-loop", "multidraw", "queue", "recorded",
+        "separate-meshes", "pooled-meshes", "stream-meshes", "stream-meshes-pointers", "shuffled-mesh", "optimized-mesh", "compact-mesh", "uniform-blocks" };
+    return names;
+}
+
+std::unique_ptr<BenchScene> CreateBenchScene(const std::string& name, const SceneParams& params)
+{
+    if (name == "per-quad")
+        return std::unique_ptr<BenchScene>(new PerQuadScene(params));
+    if (name == "batched")
+        return std::unique_ptr<BenchScene>(new BatchedScene(params));
+    if (name == "batched-50k")
+    {
+        //The sprite count the batch renderer is sized for, more than its vertex ring holds in one frame
+        SceneParams sprites = params;
+        sprites.Objects = 50000;
+        return std::unique_ptr<BenchScene>(new BatchedScene(sprites));
+    }
+    if (name == "instanced")
+        return std::unique_ptr<BenchScene>(new InstancedScene(params));
+    if (name == "indirect-loop")
+        return std::unique_ptr<BenchScene>(new IndirectScene(params, false));
+    if (name == "multidraw")
+    {
+        if (!IndirectDrawList::IsMultiDrawSupported())
+        {
+            std::cout << "[Bench] multidraw needs GL 4.3 or ARB_multi_draw_indirect, skipped" << std::endl;
+            return nullptr;
+        }
+        return std::unique_ptr<BenchScene>(new IndirectScene(params, true));
+    }
+    if (name == "queue")
+        return std::unique_ptr<BenchScene>(new QueueScene(params));
+    if (name == "recorded")
+        return std::unique_ptr<BenchScene>(new RecordedScene(params));
+    if (name == "separate-meshes")
+        return std::unique_ptr<BenchScene>(new MeshesScene(params, MeshesScene::Mode::Separate));
+    if (name == "pooled-meshes")
+        return std::unique_ptr<BenchScene>(new MeshesScene(params, MeshesScene::Mode::Pooled));
+    if (name == "stream-meshes")
+    {
+        if (!VertexArrayCache::IsAttribBindingSupported())
+        {
+            std::cout << "[Bench] stream-meshes needs GL 4.3 or ARB_vertex_attrib_binding, skipped" << std::endl;
+            return nullptr;
+        }
+        return std::unique_ptr<BenchScene>(new MeshesScene(params, MeshesScene::Mode::Streams));
+    }
+    if (name == "stream-meshes-pointers")
+        return std::unique_ptr<BenchScene>(new MeshesScene(params, MeshesScene::Mode::StreamsPointers));
+    if (name == "shuffled-mesh")
+        return std::unique_ptr<BenchScene>(new GridMeshScene(params, false, false));
+    if (name == "optimized-mesh")
+        return std::unique_ptr<BenchScene>(new GridMeshScene(params, true, false));
+    if (name == "compact-mesh")
+        return std::unique_ptr<BenchScene>(new GridMeshScene(params, true, true));
+    if (name == "uniform-blocks")
+        return std::unique_ptr<BenchScene>(new UniformBlocksScene(params));
+
+    std::cout << "[Bench] Unknown scene " << name << std::endl;
+    return nullptr;
+}
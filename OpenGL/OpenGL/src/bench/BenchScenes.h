@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+
+struct SceneParams
+{
+	unsigned int Objects = 10000; //Quads, instances or draws, depending on the scene
+	unsigned int Textures = 8;
+	unsigned int Shaders = 4; //Only the queue scene mixes programs
+	unsigned int Shapes = 16; //Distinct meshes for the indirect scenes
+	int Width = 960, Height = 540;
+};
+
+//A synthetic workload for renderer_bench. Resources are created in the constructor, so their uploads
+//don't count as per-frame work; Render draws one frame into the current framebuffer, clear included.
+class BenchScene
+{
+public:
+	virtual ~BenchScene() {}
+	virtual void Render() = 0;
+};
+
+const std::vector<std::string>& GetBenchSceneNames();
+//nullptr when the name is unknown or the context lacks what the scene needs
+std::unique_ptr<BenchScene> CreateBenchScene(const std::string& name, const SceneParams& params);
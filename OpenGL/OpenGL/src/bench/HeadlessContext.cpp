@@ -0,0 +1,86 @@
+#include "HeadlessContext.h"
+#include "Renderer.h"
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+HeadlessContext::HeadlessContext(int width, int height, int major, int minor)
+    :m_Display(nullptr), m_Context(nullptr), m_Framebuffer(0), m_ColorAttachment(0), m_Width(width), m_Height(height), m_Valid(false)
+{
+    EGLDisplay display = EGL_NO_DISPLAY;
+    //Prefer the surfaceless platform so no X server or DRM device is required
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay)
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    if (display == EGL_NO_DISPLAY)
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    EGLint eglMajor, eglMinor;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &eglMajor, &eglMinor))
+    {
+        std::cout << "[Headless] Failed to initialize EGL" << std::endl;
+        return;
+    }
+    m_Display = display;
+
+    eglBindAPI(EGL_OPENGL_API);
+    const EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, major,
+        EGL_CONTEXT_MINOR_VERSION, minor,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT, //Same profile as Sandbox
+#ifdef GL_CHECKS_ENABLED
+        EGL_CONTEXT_OPENGL_DEBUG, EGL_TRUE,
+#endif
+        EGL_NONE
+    };
+    EGLContext context = eglCreateContext(display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, contextAttributes);
+    if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+    {
+        std::cout << "[Headless] Failed to create a " << major << "." << minor << " core context (" << eglGetError() << ")" << std::endl;
+        return;
+    }
+    m_Context = context;
+
+    glewExperimental = GL_TRUE;
+    GLenum result = glewInit();
+    //GLEW also tries to load GLX entry points and complains when there is no X display, GL itself is fine
+    if (result != GLEW_OK && result != GLEW_ERROR_NO_GLX_DISPLAY)
+    {
+        std::cout << "[Headless] glewInit failed: " << glewGetErrorString(result) << std::endl;
+        return;
+    }
+#ifdef GL_CHECKS_ENABLED
+    GLDebug::Init();
+#endif
+
+    GLCall(glGenRenderbuffers(1, &m_ColorAttachment));
+    GLCall(glBindRenderbuffer(GL_RENDERBUFFER, m_ColorAttachment));
+    GLCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height));
+    GLCall(glGenFramebuffers(1, &m_Framebuffer));
+    GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_Framebuffer));
+    GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_ColorAttachment));
+    GLCall(glViewport(0, 0, width, height));
+
+    std::cout << glGetString(GL_VERSION) << " (" << glGetString(GL_RENDERER) << ")" << std::endl;
+    m_Valid = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+}
+
+HeadlessContext::~HeadlessContext()
+{
+    if (m_Framebuffer)
+    {
+        GLCall(glDeleteFramebuffers(1, &m_Framebuffer));
+        GLCall(glDeleteRenderbuffers(1, &m_ColorAttachment));
+    }
+    if (m_Context)
+    {
+        eglMakeCurrent((EGLDisplay)m_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext((EGLDisplay)m_Display, (EGLContext)m_Context);
+    }
+    if (m_Display)
+        eglTerminate((EGLDisplay)m_Display);
+}
+
+void HeadlessContext::Finish() const
+{
+    GLCall(glFinish());
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+//Offscreen OpenGL context for benchmarks, no window or display needed.
+//Uses EGL (surfaceless platform when available), so it runs on Mesa llvmpipe in CI.
+//Rendering goes into an internal framebuffer of the requested size.
+class HeadlessContext
+{
+private:
+	void* m_Display;
+	void* m_Context;
+	unsigned int m_Framebuffer;
+	unsigned int m_ColorAttachment;
+	int m_Width, m_Height;
+	bool m_Valid;
+public:
+	HeadlessContext(int width, int height, int major = 3, int minor = 3);
+	~HeadlessContext();
+
+	void Finish() const; //Waits until the GPU finished all submitted work
+
+	inline bool IsValid() const { return m_Valid; }
+	inline int GetWidth() const { return m_Width; }
+	inline int GetHeight() const { return m_Height; }
+};
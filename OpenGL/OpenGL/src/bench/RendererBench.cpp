@@ -0,0 +1,341 @@
+//renderer_bench: synthetic scenes on an offscreen context, results as JSON. Runs without a GPU or
+//a display (Mesa llvmpipe through EGL), so CI can track every performance change to the renderer.
+//Not part of the Visual Studio build (it has its own main), CMakeLists.txt builds it. On Linux, from OpenGL/OpenGL:
+//  cmake -S . -B build -DCMAKE_BUILD_TYPE=Release && cmake --build build -j
+//  LIBGL_ALWAYS_SOFTWARE=1 build/renderer_bench --scenes batched,instanced --objects 20000 --frames 100 --out bench.json
+//Every frame ends with glFinish, so ms/frame covers the CPU and the GPU side of the frame.
+//Program creation is timed before the scenes, with the ProgramCache in DIR if --program-cache DIR is given.
+//Cold vs warm: run twice on the same DIR, each time with an empty MESA_SHADER_CACHE_DIR so Mesa's own disk cache
+//doesn't hide the compile time (MESA_SHADER_CACHE_DISABLE also turns off program binaries).
+//The ShaderLibrary loads (manifest built over frames, then in parallel where supported) never use the program cache,
+//with Mesa's cache on they measure cache hits after the first run.
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include "HeadlessContext.h"
+#include "BenchScenes.h"
+#include "Renderer.h"
+#include "GLStateCache.h"
+#include "DeletionQueue.h"
+#include "GpuMemory.h"
+#include "VertexArrayCache.h"
+#include "ProgramCache.h"
+#include "Shader.h"
+#include "ShaderLibrary.h"
+
+struct SceneResult
+{
+    std::string Name;
+    std::vector<double> FrameMs; //Sorted
+    double MeanMs = 0.0;
+    double DrawCalls = 0.0; //All per frame
+    double Binds = 0.0;
+    double BindsSkipped = 0.0;
+    double VertexArrayBinds = 0.0;
+    unsigned long long GpuMemoryBytes = 0; //Held by the scene's resources
+    double BytesUploaded = 0.0;
+};
+
+struct ProgramStartup
+{
+    double Ms = 0.0;
+    bool Cached = false;
+    ProgramCache::Stats Stats;
+};
+
+//Programs of the manifest loaded through a ShaderLibrary, with an Update per "frame" until all are done
+struct LibraryLoad
+{
+    bool Parallel = false;
+    double AddMs = 0.0; //LoadManifest, all of it blocks the caller
+    double MaxUpdateMs = 0.0; //Worst frame
+    double TotalMs = 0.0; //Until every program is ready
+    unsigned int Frames = 0;
+};
+
+static const char* s_ProgramPaths[] = { "resources/shaders/Basic.shader", "resources/shaders/Batch.shader",
+    "resources/shaders/Instanced.shader", "resources/shaders/MultiDraw.shader", "resources/shaders/Blocks.shader" };
+
+static double Percentile(const std::vector<double>& sorted, double p)
+{
+    //Nearest rank
+    size_t rank = (size_t)(p / 100.0 * sorted.size() + 0.5);
+    return sorted[std::min(std::max(rank, (size_t)1), sorted.size()) - 1];
+}
+
+static SceneResult RunScene(const HeadlessContext& context, const std::string& name, BenchScene& scene, unsigned int warmup, unsigned int frames)
+{
+    for (unsigned int i = 0; i < warmup; i++)
+    {
+        scene.Render();
+        DeletionQueue::Get().EndFrame();
+        GpuMemory::Get().EndFrame();
+    }
+    context.Finish();
+
+    SceneResult result;
+    result.Name = name;
+    result.GpuMemoryBytes = GpuMemory::Get().GetTotalUsage().Current - GpuMemory::Get().GetDeferredBytes(); //Not what earlier scenes left behind
+    GLStateCache& cache = GLStateCache::Get();
+    for (unsigned int i = 0; i < frames; i++)
+    {
+        cache.ResetStats();
+        auto start = std::chrono::high_resolution_clock::now();
+        scene.Render();
+        DeletionQueue::Get().EndFrame();
+        GpuMemory::Get().EndFrame();
+        context.Finish();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+        result.FrameMs.push_back(elapsed.count());
+        const GLStateCache::Stats& stats = cache.GetStats();
+        result.DrawCalls += stats.DrawCalls;
+        result.Binds += stats.Issued;
+        result.BindsSkipped += stats.Skipped;
+        result.VertexArrayBinds += stats.VertexArrayBinds;
+        result.BytesUploaded += (double)stats.BytesUploaded;
+    }
+
+    std::sort(result.FrameMs.begin(), result.FrameMs.end());
+    for (double ms : result.FrameMs)
+        result.MeanMs += ms;
+    result.MeanMs /= frames;
+    result.DrawCalls /= frames;
+    result.Binds /= frames;
+    result.BindsSkipped /= frames;
+    result.VertexArrayBinds /= frames;
+    result.BytesUploaded /= frames;
+    return result;
+}
+
+//Creates every program the scenes use, until it could draw with them
+static double CreatePrograms(const HeadlessContext& context)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    {
+        std::vector<std::unique_ptr<Shader>> shaders;
+        for (const char* path : s_ProgramPaths)
+            shaders.emplace_back(new Shader(path));
+        context.Finish();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+    DeletionQueue::Get().Flush();
+    return elapsed.count();
+}
+
+static ProgramStartup MeasureProgramStartup(const HeadlessContext& context, const std::string& cacheDirectory)
+{
+    ProgramStartup startup;
+    ProgramCache& cache = ProgramCache::Get();
+    startup.Cached = !cacheDirectory.empty();
+    cache.SetEnabled(startup.Cached);
+    cache.SetDirectory(cacheDirectory);
+    startup.Ms = CreatePrograms(context);
+    startup.Stats = cache.GetStats();
+    return startup;
+}
+
+static LibraryLoad MeasureLibraryLoad(const HeadlessContext& context, bool parallel)
+{
+    //Compiled for real, not loaded from the program cache
+    ProgramCache& cache = ProgramCache::Get();
+    bool cached = cache.IsEnabled();
+    cache.SetEnabled(false);
+
+    LibraryLoad load;
+    {
+        ShaderLibrary library;
+        library.SetParallelEnabled(parallel);
+        load.Parallel = library.IsParallelEnabled();
+        context.Finish();
+
+        auto start = std::chrono::high_resolution_clock::now();
+        library.LoadManifest("resources/shaders/Programs.manifest");
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+        load.AddMs = elapsed.count();
+        while (library.IsLoading())
+        {
+            library.Update();
+            load.MaxUpdateMs = std::max(load.MaxUpdateMs, library.GetStats().UpdateMs);
+            load.Frames++;
+        }
+        elapsed = std::chrono::high_resolution_clock::now() - start;
+        load.TotalMs = elapsed.count();
+    }
+    DeletionQueue::Get().Flush();
+    cache.SetEnabled(cached);
+    return load;
+}
+
+static void WriteJson(std::ostream& stream, const SceneParams& params, unsigned int warmup, unsigned int frames, const ProgramStartup& startup,
+    const std::vector<LibraryLoad>& loads, const std::vector<SceneResult>& results)
+{
+    stream << "{\n";
+    stream << "  \"gl_version\": \"" << glGetString(GL_VERSION) << "\",\n";
+    stream << "  \"gl_renderer\": \"" << glGetString(GL_RENDERER) << "\",\n";
+    stream << "  \"params\": { \"objects\": " << params.Objects << ", \"textures\": " << params.Textures
+        << ", \"shaders\": " << params.Shaders << ", \"shapes\": " << params.Shapes
+        << ", \"width\": " << params.Width << ", \"height\": " << params.Height
+        << ", \"warmup\": " << warmup << ", \"frames\": " << frames << " },\n";
+    stream << "  \"program_startup\": { \"ms\": " << startup.Ms << ", \"programs\": " << sizeof(s_ProgramPaths) / sizeof(s_ProgramPaths[0])
+        << ", \"cached\": " << (startup.Cached ? "true" : "false") << ", \"hits\": " << startup.Stats.Hits
+        << ", \"stored\": " << startup.Stats.Stored << " },\n";
+    stream << "  \"shader_library\": [";
+    for (size_t i = 0; i < loads.size(); i++)
+        stream << (i ? ", " : "") << "{ \"parallel\": " << (loads[i].Parallel ? "true" : "false") << ", \"add_ms\": " << loads[i].AddMs
+            << ", \"max_update_ms\": " << loads[i].MaxUpdateMs << ", \"total_ms\": " << loads[i].TotalMs << ", \"frames\": " << loads[i].Frames << " }";
+    stream << "],\n";
+    stream << "  \"scenes\": [";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const SceneResult& result = results[i];
+        stream << (i ? "," : "") << "\n    {\n";
+        stream << "      \"name\": \"" << result.Name << "\",\n";
+        stream << "      \"ms_per_frame\": { \"mean\": " << result.MeanMs
+            << ", \"min\": " << result.FrameMs.front()
+            << ", \"p50\": " << Percentile(result.FrameMs, 50.0)
+            << ", \"p90\": " << Percentile(result.FrameMs, 90.0)
+            << ", \"p99\": " << Percentile(result.FrameMs, 99.0)
+            << ", \"max\": " << result.FrameMs.back() << " },\n";
+        stream << "      \"draw_calls_per_frame\": " << result.DrawCalls << ",\n";
+        stream << "      \"state_changes_per_frame\": " << result.Binds << ",\n";
+        stream << "      \"redundant_binds_skipped_per_frame\": " << result.BindsSkipped << ",\n";
+        stream << "      \"vertex_array_binds_per_frame\": " << result.VertexArrayBinds << ",\n";
+        stream << "      \"bytes_uploaded_per_frame\": " << result.BytesUploaded << ",\n";
+        stream << "      \"gpu_memory_bytes\": " << result.GpuMemoryBytes << "\n";
+        stream << "    }";
+    }
+    stream << "\n  ]\n}\n";
+}
+
+static void PrintUsage()
+{
+    std::cout << "Usage: renderer_bench [--scenes a,b,...|all] [--frames N] [--warmup N] [--objects N] [--textures N]" << std::endl
+        << "                      [--shaders N] [--shapes N] [--width N] [--height N] [--gl MAJOR.MINOR] [--out FILE]" << std::endl
+        << "                      [--program-cache DIR]" << std::endl
+        << "Scenes:";
+    for (const std::string& name : GetBenchSceneNames())
+        std::cout << " " << name;
+    std::cout << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    SceneParams params;
+    std::string sceneList = "all";
+    std::string outPath = "renderer_bench.json";
+    std::string programCache; //Off unless given, so runs don't depend on what earlier ones left
+    unsigned int frames = 50;
+    unsigned int warmup = 5;
+    int glMajor = 3, glMinor = 3;
+    for (int i = 1; i < argc; i++)
+    {
+        if (i + 1 >= argc)
+        {
+            PrintUsage();
+            return -1;
+        }
+        const char* value = argv[++i];
+        if (strcmp(argv[i - 1], "--scenes") == 0)
+            sceneList = value;
+        else if (strcmp(argv[i - 1], "--frames") == 0)
+            frames = atoi(value);
+        else if (strcmp(argv[i - 1], "--warmup") == 0)
+            warmup = atoi(value);
+        else if (strcmp(argv[i - 1], "--objects") == 0)
+            params.Objects = atoi(value);
+        else if (strcmp(argv[i - 1], "--textures") == 0)
+            params.Textures = atoi(value);
+        else if (strcmp(argv[i - 1], "--shaders") == 0)
+            params.Shaders = atoi(value);
+        else if (strcmp(argv[i - 1], "--shapes") == 0)
+            params.Shapes = atoi(value);
+        else if (strcmp(argv[i - 1], "--width") == 0)
+            params.Width = atoi(value);
+        else if (strcmp(argv[i - 1], "--height") == 0)
+            params.Height = atoi(value);
+        else if (strcmp(argv[i - 1], "--gl") == 0)
+            sscanf(value, "%d.%d", &glMajor, &glMinor);
+        else if (strcmp(argv[i - 1], "--out") == 0)
+            outPath = value;
+        else if (strcmp(argv[i - 1], "--program-cache") == 0)
+            programCache = value;
+        else
+        {
+            PrintUsage();
+            return -1;
+        }
+    }
+    if (frames == 0 || params.Objects == 0 || params.Textures == 0 || params.Shaders == 0 || params.Shapes == 0
+        || params.Width <= 8 || params.Height <= 8)
+    {
+        PrintUsage();
+        return -1;
+    }
+
+    std::vector<std::string> sceneNames;
+    if (sceneList == "all")
+        sceneNames = GetBenchSceneNames();
+    else
+    {
+        std::stringstream stream(sceneList);
+        std::string name;
+        while (std::getline(stream, name, ','))
+            sceneNames.push_back(name);
+    }
+
+    HeadlessContext context(params.Width, params.Height, glMajor, glMinor);
+    if (!context.IsValid())
+        return -1;
+
+    GLCall(glEnable(GL_BLEND));
+    GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+
+    ProgramStartup startup = MeasureProgramStartup(context, programCache);
+    std::cout << "programs : " << startup.Ms << " ms";
+    if (startup.Cached)
+        std::cout << ", " << startup.Stats.Hits << " from " << programCache << ", " << startup.Stats.Stored << " stored";
+    std::cout << std::endl;
+
+    std::vector<LibraryLoad> loads;
+    loads.push_back(MeasureLibraryLoad(context, false));
+    if (Shader::IsParallelCompileSupported())
+        loads.push_back(MeasureLibraryLoad(context, true));
+    for (const LibraryLoad& load : loads)
+        std::cout << "shader library (" << (load.Parallel ? "parallel" : "over frames") << ") : " << load.AddMs << " ms to add, worst frame "
+            << load.MaxUpdateMs << " ms, ready after " << load.TotalMs << " ms and " << load.Frames << " frames" << std::endl;
+
+    std::vector<SceneResult> results;
+    for (const std::string& name : sceneNames)
+    {
+        std::unique_ptr<BenchScene> scene = CreateBenchScene(name, params);
+        if (!scene)
+            continue;
+
+        results.push_back(RunScene(context, name, *scene, warmup, frames));
+        const SceneResult& result = results.back();
+        std::cout << name << " : p50 " << Percentile(result.FrameMs, 50.0) << " ms, p99 " << Percentile(result.FrameMs, 99.0) << " ms, "
+            << result.DrawCalls << " draws, " << result.Binds << " binds (" << result.VertexArrayBinds << " vertex arrays), " << result.BytesUploaded << " bytes uploaded per frame, "
+            << result.GpuMemoryBytes / 1024 << " KB of GPU memory" << std::endl;
+    }
+
+    VertexArrayCache::Get().Clear();
+    DeletionQueue::Get().Flush();
+
+    std::ofstream out(outPath);
+    if (!out)
+    {
+        std::cout << "Could not write " << outPath << std::endl;
+        return -1;
+    }
+    WriteJson(out, params, warmup, frames, startup, loads, results);
+    std::cout << "Results written to " << outPath << std::endl;
+    return results.empty() ? -1 : 0;
+}